@@ -0,0 +1,338 @@
+#include "base_image.h"
+#include "mapped_file.h"
+#include "serialization.h"
+
+#include <transport_catalogue.pb.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace transport_catalogue {
+    
+namespace {
+const char SIGNATURE[8] = {'T', 'C', 'I', 'M', 'A', 'G', 'E', '\0'};
+const std::uint32_t VERSION = 1;
+const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+const size_t SECTION_ALIGNMENT = 8;
+
+enum class SectionId : std::uint32_t {
+    SETTINGS,
+    SCALARS,
+    STOP_LATITUDES,
+    STOP_LONGITUDES,
+    NAMES,
+    STOP_NAME_OFFSETS,
+    BUS_NAME_OFFSETS,
+    ROUTE_STOPS,
+    ROUTE_OFFSETS,
+    IS_ROUNDTRIP,
+    STOP_NAME_DISPLACEMENTS,
+    STOP_NAME_SLOTS,
+    BUS_NAME_DISPLACEMENTS,
+    BUS_NAME_SLOTS,
+    STOP_PREFIX_ORDER,
+    BUS_PREFIX_ORDER,
+    SPATIAL_CELL_OFFSETS,
+    SPATIAL_STOPS,
+    STOP_BUSES_OFFSETS,
+    STOP_BUSES,
+    ROAD_DISTANCES_OFFSETS,
+    ROAD_DISTANCES,
+    BUS_POSITIONS_OFFSETS,
+    BUS_STOP_POSITIONS,
+    ROUTE_DISTANCES,
+    BUS_STATS
+};
+
+struct Header {
+    char signature[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint32_t coordinate_size;
+    std::uint32_t section_count;
+};
+
+// Размер секции задан в элементах
+struct SectionEntry {
+    std::uint32_t id;
+    std::uint32_t element_size;
+    std::uint64_t offset;
+    std::uint64_t size;
+};
+
+// Величины вне массивов
+struct Scalars {
+    std::uint64_t stop_name_seed;
+    std::uint64_t bus_name_seed;
+    StopSpatialIndex::Grid grid;
+};
+
+size_t Align(size_t offset) {
+    return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+class SectionWriter {
+public:
+    template <typename T>
+    void Add(SectionId id, const T* data, size_t size) {
+        sections_.push_back({{static_cast<std::uint32_t>(id), sizeof(T), 0, size},
+                             reinterpret_cast<const char*>(data)});
+    }
+    
+    template <typename Container>
+    void Add(SectionId id, const Container& values) {
+        Add(id, values.data(), values.size());
+    }
+    
+    void Write(std::ostream& out) {
+        Header header;
+        std::memcpy(header.signature, SIGNATURE, sizeof(SIGNATURE));
+        header.version = VERSION;
+        header.byte_order = BYTE_ORDER_MARK;
+        header.coordinate_size = sizeof(CoordinateValue);
+        header.section_count = sections_.size();
+        
+        size_t offset = Align(sizeof(Header) + sections_.size() * sizeof(SectionEntry));
+        for (auto& [entry, data]: sections_) {
+            entry.offset = offset;
+            offset = Align(offset + entry.element_size * entry.size);
+        }
+        
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const auto& [entry, data]: sections_) {
+            out.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        }
+        size_t position = sizeof(Header) + sections_.size() * sizeof(SectionEntry);
+        for (const auto& [entry, data]: sections_) {
+            WritePadding(out, entry.offset - position);
+            out.write(data, entry.element_size * entry.size);
+            position = entry.offset + entry.element_size * entry.size;
+        }
+        WritePadding(out, Align(position) - position);
+    }
+    
+private:
+    std::vector<std::pair<SectionEntry, const char*>> sections_;
+    
+    static void WritePadding(std::ostream& out, size_t size) {
+        const char zeros[SECTION_ALIGNMENT] = {};
+        out.write(zeros, size);
+    }
+};
+
+class SectionReader {
+public:
+    explicit SectionReader(const MappedFile& file)
+        : file_(file) {
+    }
+    
+    bool ReadTable() {
+        if (file_.GetSize() < sizeof(Header)) {
+            return false;
+        }
+        
+        Header header;
+        std::memcpy(&header, file_.GetData(), sizeof(header));
+        if (std::memcmp(header.signature, SIGNATURE, sizeof(SIGNATURE)) != 0 || header.version != VERSION
+            || header.byte_order != BYTE_ORDER_MARK || header.coordinate_size != sizeof(CoordinateValue)
+            || file_.GetSize() < sizeof(Header) + std::uint64_t{header.section_count} * sizeof(SectionEntry)) {
+            return false;
+        }
+        
+        const char* table = file_.GetData() + sizeof(Header);
+        for (std::uint32_t i = 0; i != header.section_count; ++i) {
+            SectionEntry entry;
+            std::memcpy(&entry, table + i * sizeof(SectionEntry), sizeof(entry));
+            if (entry.element_size == 0 || entry.offset % SECTION_ALIGNMENT != 0 || entry.offset > file_.GetSize()
+                || entry.size > (file_.GetSize() - entry.offset) / entry.element_size) {
+                return false;
+            }
+            sections_[entry.id] = entry;
+        }
+        return true;
+    }
+    
+    // Колонка ссылается на память файла. false, если секции нет или размер её элемента не совпадает
+    template <typename T>
+    bool Read(SectionId id, storage::Column<T>& column) const {
+        auto it = sections_.find(static_cast<std::uint32_t>(id));
+        if (it == sections_.end() || it->second.element_size != sizeof(T)) {
+            return false;
+        }
+        column = storage::Column<T>(reinterpret_cast<const T*>(file_.GetData() + it->second.offset), it->second.size);
+        return true;
+    }
+    
+private:
+    const MappedFile& file_;
+    std::unordered_map<std::uint32_t, SectionEntry> sections_;
+};
+
+bool HasOffsets(const storage::Column<std::uint32_t>& offsets, size_t count, size_t data_size) {
+    return storage::IsValidOffsets(offsets, count, 0, data_size);
+}
+
+// Позиции остановок автобуса индексируют его отрезок путей от начала маршрута
+bool HasValidPositions(const storage::Column<std::uint32_t>& offsets, const storage::Column<StopPosition>& positions, size_t stop_count) {
+    for (size_t bus_id = 0; bus_id + 1 < offsets.size(); ++bus_id) {
+        const auto route_size = offsets[bus_id + 1] - offsets[bus_id];
+        for (auto i = offsets[bus_id]; i != offsets[bus_id + 1]; ++i) {
+            if (positions[i].stop >= stop_count || positions[i].position >= route_size) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+}
+    
+void BaseImage::Write(std::ostream& out, const CatalogueSnapshot& snapshot,
+                      const RenderSettings& render_settings, const RoutingSettings& routing_settings) {
+    transport_catalogue_serialize::BaseSettings settings_serialize;
+    *settings_serialize.mutable_render_settings() = SerializeRenderSettings(render_settings);
+    *settings_serialize.mutable_routing_settings() = SerializeRoutingSettings(routing_settings);
+    const auto settings = settings_serialize.SerializeAsString();
+    
+    const auto& columns = snapshot.columns_;
+    const auto& stop_spatial_index = snapshot.stop_spatial_index_;
+    const Scalars scalars{snapshot.stop_name_index_.GetSeed(), snapshot.bus_name_index_.GetSeed(), stop_spatial_index.GetGrid()};
+    const auto stop_prefix_order = snapshot.stop_prefix_index_.GetOrder();
+    const auto bus_prefix_order = snapshot.bus_prefix_index_.GetOrder();
+    
+    SectionWriter writer;
+    writer.Add(SectionId::SETTINGS, settings);
+    writer.Add(SectionId::SCALARS, &scalars, 1);
+    writer.Add(SectionId::STOP_LATITUDES, columns.lats_);
+    writer.Add(SectionId::STOP_LONGITUDES, columns.lngs_);
+    writer.Add(SectionId::NAMES, columns.names_);
+    writer.Add(SectionId::STOP_NAME_OFFSETS, columns.stop_name_offsets_);
+    writer.Add(SectionId::BUS_NAME_OFFSETS, columns.bus_name_offsets_);
+    writer.Add(SectionId::ROUTE_STOPS, columns.route_stops_);
+    writer.Add(SectionId::ROUTE_OFFSETS, columns.route_offsets_);
+    writer.Add(SectionId::IS_ROUNDTRIP, columns.is_roundtrip_);
+    writer.Add(SectionId::STOP_NAME_DISPLACEMENTS, snapshot.stop_name_index_.GetDisplacements());
+    writer.Add(SectionId::STOP_NAME_SLOTS, snapshot.stop_name_index_.GetSlots());
+    writer.Add(SectionId::BUS_NAME_DISPLACEMENTS, snapshot.bus_name_index_.GetDisplacements());
+    writer.Add(SectionId::BUS_NAME_SLOTS, snapshot.bus_name_index_.GetSlots());
+    writer.Add(SectionId::STOP_PREFIX_ORDER, stop_prefix_order.begin(), stop_prefix_order.end() - stop_prefix_order.begin());
+    writer.Add(SectionId::BUS_PREFIX_ORDER, bus_prefix_order.begin(), bus_prefix_order.end() - bus_prefix_order.begin());
+    writer.Add(SectionId::SPATIAL_CELL_OFFSETS, stop_spatial_index.GetCellOffsets());
+    writer.Add(SectionId::SPATIAL_STOPS, stop_spatial_index.GetStops());
+    writer.Add(SectionId::STOP_BUSES_OFFSETS, snapshot.stop_buses_offsets_);
+    writer.Add(SectionId::STOP_BUSES, snapshot.stop_buses_);
+    writer.Add(SectionId::ROAD_DISTANCES_OFFSETS, snapshot.road_distances_offsets_);
+    writer.Add(SectionId::ROAD_DISTANCES, snapshot.road_distances_);
+    writer.Add(SectionId::BUS_POSITIONS_OFFSETS, snapshot.bus_positions_offsets_);
+    writer.Add(SectionId::BUS_STOP_POSITIONS, snapshot.bus_stop_positions_);
+    writer.Add(SectionId::ROUTE_DISTANCES, snapshot.route_distances_);
+    writer.Add(SectionId::BUS_STATS, snapshot.bus_stats_);
+    writer.Write(out);
+}
+    
+std::shared_ptr<const CatalogueSnapshot> BaseImage::Map(const std::string& file_name,
+                                                        RenderSettings& render_settings, RoutingSettings& routing_settings) {
+    auto file = MappedFile::Open(file_name);
+    if (!file) {
+        return nullptr;
+    }
+    SectionReader reader(*file);
+    if (!reader.ReadTable()) {
+        return nullptr;
+    }
+    
+    std::shared_ptr<CatalogueSnapshot> snapshot(new CatalogueSnapshot());
+    auto& columns = snapshot->columns_;
+    storage::Column<char> settings;
+    storage::Column<Scalars> scalars;
+    storage::Column<std::uint32_t> stop_name_displacements, stop_name_slots, bus_name_displacements, bus_name_slots;
+    storage::Column<std::uint32_t> stop_prefix_order, bus_prefix_order, spatial_cell_offsets, spatial_stops;
+    
+    const bool has_sections = reader.Read(SectionId::SETTINGS, settings)
+        && reader.Read(SectionId::SCALARS, scalars)
+        && reader.Read(SectionId::STOP_LATITUDES, columns.lats_)
+        && reader.Read(SectionId::STOP_LONGITUDES, columns.lngs_)
+        && reader.Read(SectionId::NAMES, columns.names_)
+        && reader.Read(SectionId::STOP_NAME_OFFSETS, columns.stop_name_offsets_)
+        && reader.Read(SectionId::BUS_NAME_OFFSETS, columns.bus_name_offsets_)
+        && reader.Read(SectionId::ROUTE_STOPS, columns.route_stops_)
+        && reader.Read(SectionId::ROUTE_OFFSETS, columns.route_offsets_)
+        && reader.Read(SectionId::IS_ROUNDTRIP, columns.is_roundtrip_)
+        && reader.Read(SectionId::STOP_NAME_DISPLACEMENTS, stop_name_displacements)
+        && reader.Read(SectionId::STOP_NAME_SLOTS, stop_name_slots)
+        && reader.Read(SectionId::BUS_NAME_DISPLACEMENTS, bus_name_displacements)
+        && reader.Read(SectionId::BUS_NAME_SLOTS, bus_name_slots)
+        && reader.Read(SectionId::STOP_PREFIX_ORDER, stop_prefix_order)
+        && reader.Read(SectionId::BUS_PREFIX_ORDER, bus_prefix_order)
+        && reader.Read(SectionId::SPATIAL_CELL_OFFSETS, spatial_cell_offsets)
+        && reader.Read(SectionId::SPATIAL_STOPS, spatial_stops)
+        && reader.Read(SectionId::STOP_BUSES_OFFSETS, snapshot->stop_buses_offsets_)
+        && reader.Read(SectionId::STOP_BUSES, snapshot->stop_buses_)
+        && reader.Read(SectionId::ROAD_DISTANCES_OFFSETS, snapshot->road_distances_offsets_)
+        && reader.Read(SectionId::ROAD_DISTANCES, snapshot->road_distances_)
+        && reader.Read(SectionId::BUS_POSITIONS_OFFSETS, snapshot->bus_positions_offsets_)
+        && reader.Read(SectionId::BUS_STOP_POSITIONS, snapshot->bus_stop_positions_)
+        && reader.Read(SectionId::ROUTE_DISTANCES, snapshot->route_distances_)
+        && reader.Read(SectionId::BUS_STATS, snapshot->bus_stats_);
+    if (!has_sections || scalars.size() != 1) {
+        return nullptr;
+    }
+    
+    // Снимок обращается по смещениям и номерам из файла без проверок, поэтому до его выдачи проверяется,
+    // что смещения не убывают и не выходят за свои массивы, а номера меньше числа остановок или автобусов.
+    // Проверки те же, что у чтения protobuf, и проходят по данным один раз
+    const size_t stop_count = columns.lats_.size();
+    const size_t bus_count = columns.is_roundtrip_.size();
+    const auto& road_distances = snapshot->road_distances_;
+    const bool is_consistent = columns.lngs_.size() == stop_count
+        && storage::IsValidOffsets(columns.bus_name_offsets_, bus_count,
+                                   columns.bus_name_offsets_.empty() ? 0 : columns.bus_name_offsets_[0], columns.names_.size())
+        && HasOffsets(columns.stop_name_offsets_, stop_count, columns.bus_name_offsets_[0])
+        && HasOffsets(columns.route_offsets_, bus_count, columns.route_stops_.size())
+        && storage::AreIdsBelow(columns.route_stops_, stop_count)
+        && HasOffsets(snapshot->stop_buses_offsets_, stop_count, snapshot->stop_buses_.size())
+        && storage::AreIdsBelow(snapshot->stop_buses_, bus_count)
+        && HasOffsets(snapshot->road_distances_offsets_, stop_count, road_distances.size())
+        && std::all_of(road_distances.begin(), road_distances.end(), [stop_count](const auto& road_distance) {
+               return road_distance.to < stop_count;
+           })
+        && HasOffsets(snapshot->bus_positions_offsets_, bus_count, snapshot->bus_stop_positions_.size())
+        && HasValidPositions(snapshot->bus_positions_offsets_, snapshot->bus_stop_positions_, stop_count)
+        && snapshot->route_distances_.size() == snapshot->bus_stop_positions_.size()
+        && snapshot->bus_stats_.size() == bus_count;
+    if (!is_consistent) {
+        return nullptr;
+    }
+    
+    snapshot->stop_name_index_ = perfect_hash::NameIndex(scalars[0].stop_name_seed, stop_name_displacements, stop_name_slots);
+    snapshot->bus_name_index_ = perfect_hash::NameIndex(scalars[0].bus_name_seed, bus_name_displacements, bus_name_slots);
+    snapshot->stop_prefix_index_ = NamePrefixIndex(stop_prefix_order);
+    snapshot->bus_prefix_index_ = NamePrefixIndex(bus_prefix_order);
+    snapshot->stop_spatial_index_ = StopSpatialIndex(scalars[0].grid, spatial_cell_offsets, spatial_stops);
+    if (!snapshot->stop_name_index_.IsValid(stop_count) || !snapshot->bus_name_index_.IsValid(bus_count)
+        || !snapshot->stop_prefix_index_.IsValid(stop_count) || !snapshot->bus_prefix_index_.IsValid(bus_count)
+        || !snapshot->stop_spatial_index_.IsValid(stop_count)) {
+        return nullptr;
+    }
+    
+    transport_catalogue_serialize::BaseSettings settings_serialize;
+    if (!settings_serialize.ParseFromArray(settings.data(), settings.size())) {
+        return nullptr;
+    }
+    DeserializeRenderSettings(settings_serialize.render_settings(), render_settings);
+    DeserializeRoutingSettings(settings_serialize.routing_settings(), routing_settings);
+    
+    snapshot->storage_ = std::move(file);
+    return snapshot;
+}
+    
+bool BaseImage::IsImage(const std::string& file_name) {
+    std::ifstream in(file_name, std::ios::binary);
+    char signature[sizeof(SIGNATURE)] = {};
+    return in.read(signature, sizeof(signature)) && std::memcmp(signature, SIGNATURE, sizeof(SIGNATURE)) == 0;
+}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "catalogue_snapshot.h"
+#include "map_renderer.h"
+#include "transport_router.h"
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace transport_catalogue {
+
+enum class BaseFormat {
+    PROTOBUF,
+    // Тот же protobuf с разделами, сжатыми zlib. В сборке без zlib пишется без сжатия
+    COMPRESSED_PROTOBUF,
+    IMAGE
+};
+
+// Образ снимка справочника: файл базы, который отображается в память и используется на месте.
+// Файл состоит из заголовка, таблицы секций и самих секций. Каждая секция - массив значений
+// фиксированного размера по смещению, выровненному на 8 байт, в том же виде, в каком его хранит
+// снимок. Поэтому чтение не разбирает данные и не выделяет под них память, а только один раз проверяет
+// смещения и номера, по которым снимок обращается к секциям. Формат привязан к порядку байт и типу координат сборки
+class BaseImage {
+public:
+    static void Write(std::ostream& out, const CatalogueSnapshot& snapshot,
+                      const RenderSettings& render_settings, const RoutingSettings& routing_settings);
+
+    // Возвращает nullptr, если файл не удалось отобразить или он не является образом этой сборки
+    static std::shared_ptr<const CatalogueSnapshot> Map(const std::string& file_name,
+                                                        RenderSettings& render_settings, RoutingSettings& routing_settings);
+
+    static bool IsImage(const std::string& file_name);
+};
+}
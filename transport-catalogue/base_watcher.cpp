@@ -0,0 +1,79 @@
+#include "base_watcher.h"
+#include "serialization.h"
+#include "transport_catalogue.h"
+
+#include <fstream>
+#include <system_error>
+#include <utility>
+
+std::shared_ptr<const LoadedBase> LoadBase(const std::string& file_name, std::uint64_t version) {
+    auto base = std::make_shared<LoadedBase>();
+    base->version = version;
+    
+    base->snapshot = LoadSnapshot(file_name, base->render_settings, base->routing_settings, {}, &base->router_graph_);
+    if (!base->snapshot) {
+        return nullptr;
+    }
+    return base;
+}
+
+const TransportRouter& LoadedBase::GetRouter() const {
+    std::call_once(router_built_, [this] {
+        if (router_graph_) {
+            router_ = std::make_unique<TransportRouter>(*snapshot, std::move(*router_graph_));
+            router_graph_.reset();
+        } else {
+            router_ = std::make_unique<TransportRouter>(*snapshot, routing_settings);
+        }
+    });
+    return *router_;
+}
+
+BaseWatcher::BaseWatcher(std::string file_name, std::chrono::milliseconds poll_interval)
+    : file_name_(std::move(file_name))
+    , poll_interval_(poll_interval) {
+    TryReload();
+    watcher_ = std::thread([this] { Watch(); });
+}
+
+BaseWatcher::~BaseWatcher() {
+    {
+        std::lock_guard guard(stop_mutex_);
+        stopped_ = true;
+    }
+    stop_condition_.notify_one();
+    watcher_.join();
+}
+
+std::shared_ptr<const LoadedBase> BaseWatcher::GetCurrent() const {
+    return std::atomic_load(&current_);
+}
+
+bool BaseWatcher::TryReload() {
+    std::error_code error;
+    const auto write_time = std::filesystem::last_write_time(file_name_, error);
+    if (error || (current_ && write_time == last_write_time_)) {
+        return false;
+    }
+    
+    // Файл мог быть прочитан во время записи. Тогда время изменения не запоминается
+    // и загрузка повторится при следующей проверке
+    const auto version = current_ ? current_->version + 1 : 0;
+    auto base = LoadBase(file_name_, version);
+    if (!base) {
+        return false;
+    }
+    
+    last_write_time_ = write_time;
+    std::atomic_store(&current_, std::move(base));
+    return true;
+}
+
+void BaseWatcher::Watch() {
+    std::unique_lock lock(stop_mutex_);
+    while (!stop_condition_.wait_for(lock, poll_interval_, [this] { return stopped_; })) {
+        lock.unlock();
+        TryReload();
+        lock.lock();
+    }
+}
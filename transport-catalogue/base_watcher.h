@@ -0,0 +1,66 @@
+#pragma once
+
+#include "catalogue_snapshot.h"
+#include "map_renderer.h"
+#include "transport_router.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+// Версия базы, прочитанная из файла, со всем, что нужно для ответов на запросы.
+// Роутер строится при первом запросе маршрута, ссылается на снимок и уничтожается раньше него
+struct LoadedBase {
+    std::uint64_t version = 0;
+    std::shared_ptr<const transport_catalogue::CatalogueSnapshot> snapshot;
+    RenderSettings render_settings;
+    RoutingSettings routing_settings;
+    
+    const TransportRouter& GetRouter() const;
+    
+private:
+    // Граф из файла базы, если он там есть. Забирается роутером при построении
+    mutable std::optional<TransportRouter::GraphData> router_graph_;
+    mutable std::once_flag router_built_;
+    mutable std::unique_ptr<TransportRouter> router_;
+    
+    friend std::shared_ptr<const LoadedBase> LoadBase(const std::string& file_name, std::uint64_t version);
+};
+
+// Возвращает nullptr, если файл базы не удалось прочитать
+std::shared_ptr<const LoadedBase> LoadBase(const std::string& file_name, std::uint64_t version);
+
+// Следит за файлом базы и в фоновом потоке загружает его новые версии.
+// Готовая версия публикуется атомарной заменой указателя: запросы, начатые на старой версии,
+// дорабатывают на ней, а старая версия освобождается, когда её отпускает последний читатель
+class BaseWatcher {
+public:
+    BaseWatcher(std::string file_name, std::chrono::milliseconds poll_interval);
+    ~BaseWatcher();
+    
+    BaseWatcher(const BaseWatcher&) = delete;
+    BaseWatcher& operator=(const BaseWatcher&) = delete;
+    
+    std::shared_ptr<const LoadedBase> GetCurrent() const;
+    
+private:
+    std::string file_name_;
+    std::chrono::milliseconds poll_interval_;
+    std::shared_ptr<const LoadedBase> current_;
+    std::filesystem::file_time_type last_write_time_;
+    
+    std::mutex stop_mutex_;
+    std::condition_variable stop_condition_;
+    bool stopped_ = false;
+    std::thread watcher_;
+    
+    bool TryReload();
+    void Watch();
+};
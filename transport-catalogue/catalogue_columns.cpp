@@ -0,0 +1,110 @@
+#include "catalogue_columns.h"
+
+#include <utility>
+
+namespace transport_catalogue {
+    
+CatalogueColumns::CatalogueColumns(const std::deque<domain::Stop>& stops, const std::deque<domain::Bus>& buses) {
+    std::vector<CoordinateValue> lats;
+    std::vector<CoordinateValue> lngs;
+    std::vector<std::uint32_t> stop_name_offsets;
+    std::vector<std::uint32_t> bus_name_offsets;
+    std::vector<std::uint32_t> route_offsets;
+    std::vector<std::uint8_t> is_roundtrip;
+    lats.reserve(stops.size());
+    lngs.reserve(stops.size());
+    stop_name_offsets.reserve(stops.size() + 1);
+    bus_name_offsets.reserve(buses.size() + 1);
+    route_offsets.reserve(buses.size() + 1);
+    is_roundtrip.reserve(buses.size());
+    
+    size_t names_size = 0;
+    size_t route_stops_size = 0;
+    for (const auto& stop: stops) {
+        names_size += stop.name.size();
+    }
+    for (const auto& bus: buses) {
+        names_size += bus.name.size();
+        route_stops_size += bus.route.size();
+    }
+    std::vector<char> names;
+    std::vector<StopId> route_stops;
+    names.reserve(names_size);
+    route_stops.reserve(route_stops_size);
+    
+    stop_name_offsets.push_back(0);
+    for (const auto& stop: stops) {
+        lats.push_back(static_cast<CoordinateValue>(stop.coordinates.lat));
+        lngs.push_back(static_cast<CoordinateValue>(stop.coordinates.lng));
+        names.insert(names.end(), stop.name.begin(), stop.name.end());
+        stop_name_offsets.push_back(names.size());
+    }
+    
+    bus_name_offsets.push_back(names.size());
+    route_offsets.push_back(0);
+    for (const auto& bus: buses) {
+        names.insert(names.end(), bus.name.begin(), bus.name.end());
+        bus_name_offsets.push_back(names.size());
+        for (auto stop: bus.route) {
+            route_stops.push_back(static_cast<StopId>(stop->id));
+        }
+        route_offsets.push_back(route_stops.size());
+        is_roundtrip.push_back(bus.is_roundtrip);
+    }
+    
+    lats_ = std::move(lats);
+    lngs_ = std::move(lngs);
+    names_ = std::move(names);
+    stop_name_offsets_ = std::move(stop_name_offsets);
+    bus_name_offsets_ = std::move(bus_name_offsets);
+    route_stops_ = std::move(route_stops);
+    route_offsets_ = std::move(route_offsets);
+    is_roundtrip_ = std::move(is_roundtrip);
+}
+    
+size_t CatalogueColumns::GetStopCount() const {
+    return lats_.size();
+}
+    
+std::string_view CatalogueColumns::GetStopName(size_t stop_id) const {
+    return GetName(stop_name_offsets_, stop_id);
+}
+    
+geo::Coordinates CatalogueColumns::GetStopCoordinates(size_t stop_id) const {
+    return {lats_[stop_id], lngs_[stop_id]};
+}
+    
+const storage::Column<CoordinateValue>& CatalogueColumns::GetLatitudes() const {
+    return lats_;
+}
+    
+const storage::Column<CoordinateValue>& CatalogueColumns::GetLongitudes() const {
+    return lngs_;
+}
+    
+size_t CatalogueColumns::GetBusCount() const {
+    return is_roundtrip_.size();
+}
+    
+std::string_view CatalogueColumns::GetBusName(size_t bus_id) const {
+    return GetName(bus_name_offsets_, bus_id);
+}
+    
+CatalogueColumns::RouteRange CatalogueColumns::GetBusRoute(size_t bus_id) const {
+    const auto* stops = route_stops_.data();
+    return {stops + route_offsets_[bus_id], stops + route_offsets_[bus_id + 1]};
+}
+    
+CatalogueColumns::FullRoute CatalogueColumns::GetBusFullRoute(size_t bus_id) const {
+    const auto route = GetBusRoute(bus_id);
+    return {route.begin(), route.end(), IsRoundtrip(bus_id)};
+}
+    
+bool CatalogueColumns::IsRoundtrip(size_t bus_id) const {
+    return is_roundtrip_[bus_id];
+}
+    
+std::string_view CatalogueColumns::GetName(const storage::Column<std::uint32_t>& offsets, size_t id) const {
+    return std::string_view(names_.data() + offsets[id], offsets[id + 1] - offsets[id]);
+}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "geo.h"
+#include "column.h"
+#include "domain.h"
+#include "ranges.h"
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace transport_catalogue {
+
+#ifdef TRANSPORT_CATALOGUE_FLOAT_COORDINATES
+using CoordinateValue = float;
+#else
+using CoordinateValue = double;
+#endif
+
+// Колоночное (structure-of-arrays) представление остановок и маршрутов замороженного справочника.
+// Идентификаторы остановок и автобусов совпадают с их порядковыми номерами в TransportCatalogue
+class CatalogueColumns {
+public:
+    using StopId = std::uint32_t;
+    using RouteRange = ranges::Range<const StopId*>;
+    using FullRoute = domain::RouteView<const StopId*>;
+    
+    CatalogueColumns() = default;
+    CatalogueColumns(const std::deque<domain::Stop>& stops, const std::deque<domain::Bus>& buses);
+    
+    size_t GetStopCount() const;
+    std::string_view GetStopName(size_t stop_id) const;
+    geo::Coordinates GetStopCoordinates(size_t stop_id) const;
+    const storage::Column<CoordinateValue>& GetLatitudes() const;
+    const storage::Column<CoordinateValue>& GetLongitudes() const;
+    
+    size_t GetBusCount() const;
+    std::string_view GetBusName(size_t bus_id) const;
+    // Остановки в том виде, в каком хранятся: у некольцевого маршрута только прямой проход
+    RouteRange GetBusRoute(size_t bus_id) const;
+    FullRoute GetBusFullRoute(size_t bus_id) const;
+    bool IsRoundtrip(size_t bus_id) const;
+    
+private:
+    // Файл базы читает и пишет колонки напрямую
+    friend class BaseImage;
+    
+    storage::Column<CoordinateValue> lats_;
+    storage::Column<CoordinateValue> lngs_;
+    // Имена всех остановок, а за ними всех автобусов, записанные подряд
+    storage::Column<char> names_;
+    storage::Column<std::uint32_t> stop_name_offsets_;
+    storage::Column<std::uint32_t> bus_name_offsets_;
+    // Маршруты всех автобусов, записанные подряд
+    storage::Column<StopId> route_stops_;
+    storage::Column<std::uint32_t> route_offsets_;
+    storage::Column<std::uint8_t> is_roundtrip_;
+    
+    std::string_view GetName(const storage::Column<std::uint32_t>& offsets, size_t id) const;
+};
+}
@@ -0,0 +1,389 @@
+#include "catalogue_snapshot.h"
+#include "transport_catalogue.h"
+#include "geo.h"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <tuple>
+#include <utility>
+
+namespace transport_catalogue {
+    
+namespace {
+template <typename Index, typename Items>
+Index BuildNameIndex(const Index& ready_index, const Items& items) {
+    if (ready_index.IsBuilt() && ready_index.GetSize() == items.size()) {
+        return ready_index;
+    }
+    
+    std::vector<std::string_view> names;
+    names.reserve(items.size());
+    for (const auto& item: items) {
+        names.push_back(item.name);
+    }
+    return Index(names);
+}
+}
+    
+CatalogueSnapshot::CatalogueSnapshot(const TransportCatalogue& catalogue)
+    : columns_(catalogue.GetStops(), catalogue.GetBuses())
+    , stop_name_index_(BuildNameIndex(catalogue.GetStopNameIndex(), catalogue.GetStops()))
+    , bus_name_index_(BuildNameIndex(catalogue.GetBusNameIndex(), catalogue.GetBuses()))
+    , stop_prefix_index_(BuildNameIndex(catalogue.GetStopPrefixIndex(), catalogue.GetStops()))
+    , bus_prefix_index_(BuildNameIndex(catalogue.GetBusPrefixIndex(), catalogue.GetBuses()))
+    , stop_spatial_index_(catalogue.GetStopSpatialIndex().IsBuilt() && catalogue.GetStopSpatialIndex().GetSize() == catalogue.GetStops().size()
+                          ? catalogue.GetStopSpatialIndex()
+                          : StopSpatialIndex(columns_)) {
+    BuildStopToBusesIndex();
+    BuildRoadDistances(catalogue);
+    BuildBusPositions();
+    BuildBusStats();
+}
+    
+std::optional<size_t> CatalogueSnapshot::FindStop(std::string_view name) const {
+    auto id = stop_name_index_.Find(name);
+    if (id && *id < columns_.GetStopCount() && columns_.GetStopName(*id) == name) {
+        return id;
+    }
+    return std::nullopt;
+}
+    
+std::optional<size_t> CatalogueSnapshot::FindBus(std::string_view name) const {
+    auto id = bus_name_index_.Find(name);
+    if (id && *id < columns_.GetBusCount() && columns_.GetBusName(*id) == name) {
+        return id;
+    }
+    return std::nullopt;
+}
+    
+std::optional<domain::StopStat> CatalogueSnapshot::GetStopStat(std::string_view name) const {
+    auto stop_id = FindStop(name);
+    if (!stop_id) {
+        return std::nullopt;
+    }
+    
+    const auto* buses = stop_buses_.data();
+    return domain::StopStat{columns_.GetStopName(*stop_id),
+                            {buses + stop_buses_offsets_[*stop_id], buses + stop_buses_offsets_[*stop_id + 1]}};
+}
+    
+std::optional<domain::BusStat> CatalogueSnapshot::GetBusStat(std::string_view name) const {
+    auto bus_id = FindBus(name);
+    if (!bus_id) {
+        return std::nullopt;
+    }
+    
+    const auto& stat = bus_stats_[*bus_id];
+    return domain::BusStat{columns_.GetBusName(*bus_id), stat.stop_count, stat.unique_stop_count, stat.route_length, stat.curvature};
+}
+    
+double CatalogueSnapshot::GetDistanceBetweenStops(size_t from_id, size_t to_id) const {
+    if (auto distance = FindRoadDistance(from_id, to_id)) {
+        return *distance;
+    } else if (auto distance = FindRoadDistance(to_id, from_id)) {
+        return *distance;
+    }
+    return geo::ComputeDistance(columns_.GetStopCoordinates(to_id), columns_.GetStopCoordinates(from_id));
+}
+    
+CatalogueSnapshot::RoadDistancesRange CatalogueSnapshot::GetRoadDistances(size_t from_id) const {
+    const auto* distances = road_distances_.data();
+    return {distances + road_distances_offsets_[from_id], distances + road_distances_offsets_[from_id + 1]};
+}
+    
+std::optional<std::vector<domain::DirectBus>> CatalogueSnapshot::FindDirectBuses(std::string_view from, std::string_view to) const {
+    auto from_id = FindStop(from);
+    auto to_id = FindStop(to);
+    if (!from_id || !to_id) {
+        return std::nullopt;
+    }
+    
+    // Списки автобусов остановок упорядочены по именам, поэтому общие автобусы находятся одним слиянием
+    const auto* buses = stop_buses_.data();
+    std::vector<std::uint32_t> common_buses;
+    std::set_intersection(buses + stop_buses_offsets_[*from_id], buses + stop_buses_offsets_[*from_id + 1],
+                          buses + stop_buses_offsets_[*to_id], buses + stop_buses_offsets_[*to_id + 1],
+                          std::back_inserter(common_buses), [this](auto lhs, auto rhs) {
+                              return columns_.GetBusName(lhs) < columns_.GetBusName(rhs);
+                          });
+    
+    std::vector<domain::DirectBus> result;
+    for (auto bus_id: common_buses) {
+        const auto from_positions = GetStopPositions(bus_id, *from_id);
+        const auto to_positions = GetStopPositions(bus_id, *to_id);
+        
+        // Для каждой позиции отправления берётся первая следующая за ней позиция прибытия
+        std::optional<std::pair<std::uint32_t, std::uint32_t>> best;
+        auto to_it = to_positions.begin();
+        for (const auto& from_position: from_positions) {
+            while (to_it != to_positions.end() && to_it->position <= from_position.position) {
+                ++to_it;
+            }
+            if (to_it == to_positions.end()) {
+                break;
+            }
+            if (!best || to_it->position - from_position.position < best->second - best->first) {
+                best = {from_position.position, to_it->position};
+            }
+        }
+        
+        if (best) {
+            const auto* distances = route_distances_.data() + bus_positions_offsets_[bus_id];
+            result.push_back({columns_.GetBusName(bus_id), static_cast<int>(best->second - best->first),
+                              distances[best->second] - distances[best->first]});
+        }
+    }
+    return result;
+}
+    
+std::vector<domain::NearbyStop> CatalogueSnapshot::FindNearestStops(geo::Coordinates point, size_t count, double max_distance) const {
+    std::vector<domain::NearbyStop> result;
+    for (const auto& [distance, stop_id]: stop_spatial_index_.FindNearest(columns_, point, count, max_distance)) {
+        result.push_back({columns_.GetStopName(stop_id), distance});
+    }
+    return result;
+}
+    
+std::vector<std::string_view> CatalogueSnapshot::FindStopsInBox(geo::Coordinates min, geo::Coordinates max) const {
+    std::vector<std::string_view> result;
+    for (auto stop_id: stop_spatial_index_.FindInBox(columns_, min, max)) {
+        result.push_back(columns_.GetStopName(stop_id));
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+    
+domain::Suggestions CatalogueSnapshot::Suggest(std::string_view prefix, size_t count) const {
+    domain::Suggestions suggestions;
+    
+    const auto stop_ids = stop_prefix_index_.FindByPrefix(prefix, [this](auto stop_id) { return columns_.GetStopName(stop_id); });
+    for (auto it = stop_ids.begin(); it != stop_ids.end() && suggestions.stops.size() < count; ++it) {
+        suggestions.stops.push_back(columns_.GetStopName(*it));
+    }
+    
+    const auto bus_ids = bus_prefix_index_.FindByPrefix(prefix, [this](auto bus_id) { return columns_.GetBusName(bus_id); });
+    for (auto it = bus_ids.begin(); it != bus_ids.end() && suggestions.buses.size() < count; ++it) {
+        suggestions.buses.push_back(columns_.GetBusName(*it));
+    }
+    
+    return suggestions;
+}
+    
+std::vector<geo::Coordinates> CatalogueSnapshot::GetStopsCoordinates() const {
+    const auto& lats = columns_.GetLatitudes();
+    const auto& lngs = columns_.GetLongitudes();
+    
+    std::vector<geo::Coordinates> result;
+    for (size_t stop_id = 0; stop_id != lats.size(); ++stop_id) {
+        if (HasBuses(stop_id)) {
+            result.push_back({lats[stop_id], lngs[stop_id]});
+        }
+    }
+    return result;
+}
+    
+domain::MapStat CatalogueSnapshot::GetRoutesMapStat() const {
+    domain::MapStat map_stat;
+    
+    std::vector<size_t> positions(columns_.GetStopCount());
+    for (auto stop_id: stop_prefix_index_.GetOrder()) {
+        if (HasBuses(stop_id)) {
+            positions[stop_id] = map_stat.stops.size();
+            map_stat.stops.push_back({columns_.GetStopName(stop_id), columns_.GetStopCoordinates(stop_id)});
+        }
+    }
+    
+    for (auto bus_id: bus_prefix_index_.GetOrder()) {
+        const auto route = columns_.GetBusRoute(bus_id);
+        if (route.begin() == route.end()) {
+            continue;
+        }
+        
+        domain::MapStat::BusItem bus{columns_.GetBusName(bus_id), {}, columns_.IsRoundtrip(bus_id)};
+        bus.route.reserve(route.end() - route.begin());
+        for (auto stop_id: route) {
+            bus.route.push_back(positions[stop_id]);
+        }
+        map_stat.buses.push_back(std::move(bus));
+    }
+    return map_stat;
+}
+    
+const CatalogueColumns& CatalogueSnapshot::GetColumns() const {
+    return columns_;
+}
+    
+const perfect_hash::NameIndex& CatalogueSnapshot::GetStopNameIndex() const {
+    return stop_name_index_;
+}
+    
+const perfect_hash::NameIndex& CatalogueSnapshot::GetBusNameIndex() const {
+    return bus_name_index_;
+}
+    
+const NamePrefixIndex& CatalogueSnapshot::GetStopPrefixIndex() const {
+    return stop_prefix_index_;
+}
+    
+const NamePrefixIndex& CatalogueSnapshot::GetBusPrefixIndex() const {
+    return bus_prefix_index_;
+}
+    
+const StopSpatialIndex& CatalogueSnapshot::GetStopSpatialIndex() const {
+    return stop_spatial_index_;
+}
+    
+bool CatalogueSnapshot::HasBuses(size_t stop_id) const {
+    return stop_buses_offsets_[stop_id] != stop_buses_offsets_[stop_id + 1];
+}
+    
+std::optional<int> CatalogueSnapshot::FindRoadDistance(size_t from_id, size_t to_id) const {
+    const auto distances = GetRoadDistances(from_id);
+    auto it = std::lower_bound(distances.begin(), distances.end(), to_id, [](const RoadDistance& lhs, size_t to_id) {
+        return lhs.to < to_id;
+    });
+    if (it != distances.end() && it->to == to_id) {
+        return it->distance;
+    }
+    return std::nullopt;
+}
+    
+ranges::Range<const StopPosition*> CatalogueSnapshot::GetStopPositions(size_t bus_id, size_t stop_id) const {
+    const auto* begin = bus_stop_positions_.data() + bus_positions_offsets_[bus_id];
+    const auto* end = bus_stop_positions_.data() + bus_positions_offsets_[bus_id + 1];
+    const auto* first = std::partition_point(begin, end, [stop_id](const StopPosition& item) { return item.stop < stop_id; });
+    const auto* last = std::partition_point(first, end, [stop_id](const StopPosition& item) { return item.stop == stop_id; });
+    return {first, last};
+}
+    
+void CatalogueSnapshot::BuildStopToBusesIndex() {
+    const size_t stop_count = columns_.GetStopCount();
+    
+    // Первый проход считает число различных автобусов на каждой остановке, второй раскладывает их по местам.
+    // Автобусы перебираются в порядке имён, поэтому списки остановок получаются отсортированными
+    std::vector<std::uint32_t> last_bus(stop_count, 0);
+    std::vector<std::uint32_t> offsets(stop_count + 1, 0);
+    for (auto bus_id: bus_prefix_index_.GetOrder()) {
+        for (auto stop_id: columns_.GetBusRoute(bus_id)) {
+            if (last_bus[stop_id] != bus_id + 1) {
+                last_bus[stop_id] = bus_id + 1;
+                ++offsets[stop_id + 1];
+            }
+        }
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    
+    std::vector<std::uint32_t> buses(offsets.back());
+    std::vector<std::uint32_t> positions(offsets.begin(), offsets.end() - 1);
+    std::fill(last_bus.begin(), last_bus.end(), 0);
+    for (auto bus_id: bus_prefix_index_.GetOrder()) {
+        for (auto stop_id: columns_.GetBusRoute(bus_id)) {
+            if (last_bus[stop_id] != bus_id + 1) {
+                last_bus[stop_id] = bus_id + 1;
+                buses[positions[stop_id]++] = bus_id;
+            }
+        }
+    }
+    
+    stop_buses_offsets_ = std::move(offsets);
+    stop_buses_ = std::move(buses);
+}
+    
+void CatalogueSnapshot::BuildRoadDistances(const TransportCatalogue& catalogue) {
+    std::vector<std::tuple<std::uint32_t, std::uint32_t, int>> distances;
+    distances.reserve(catalogue.GetRoadDistances().size());
+    for (const auto& [stop_pair, distance]: catalogue.GetRoadDistances()) {
+        distances.emplace_back(stop_pair.first->id, stop_pair.second->id, distance);
+    }
+    std::sort(distances.begin(), distances.end());
+    
+    std::vector<std::uint32_t> offsets(columns_.GetStopCount() + 1, 0);
+    std::vector<RoadDistance> road_distances;
+    road_distances.reserve(distances.size());
+    for (const auto& [from_id, to_id, distance]: distances) {
+        ++offsets[from_id + 1];
+        road_distances.push_back({to_id, distance});
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    
+    road_distances_offsets_ = std::move(offsets);
+    road_distances_ = std::move(road_distances);
+}
+    
+void CatalogueSnapshot::BuildBusPositions() {
+    const size_t bus_count = columns_.GetBusCount();
+    
+    std::vector<std::uint32_t> offsets(bus_count + 1, 0);
+    for (size_t bus_id = 0; bus_id != bus_count; ++bus_id) {
+        offsets[bus_id + 1] = offsets[bus_id] + columns_.GetBusFullRoute(bus_id).size();
+    }
+    
+    std::vector<StopPosition> stop_positions(offsets.back());
+    std::vector<double> route_distances(offsets.back());
+    for (size_t bus_id = 0; bus_id != bus_count; ++bus_id) {
+        const auto route = columns_.GetBusFullRoute(bus_id);
+        auto* positions = stop_positions.data() + offsets[bus_id];
+        auto* distances = route_distances.data() + offsets[bus_id];
+        
+        for (std::uint32_t i = 0; i != route.size(); ++i) {
+            positions[i] = {static_cast<std::uint32_t>(route[i]), i};
+            distances[i] = i == 0 ? 0. : distances[i - 1] + GetDistanceBetweenStops(route[i - 1], route[i]);
+        }
+        std::sort(positions, positions + route.size(), [](const auto& lhs, const auto& rhs) {
+            return std::tie(lhs.stop, lhs.position) < std::tie(rhs.stop, rhs.position);
+        });
+    }
+    
+    bus_positions_offsets_ = std::move(offsets);
+    bus_stop_positions_ = std::move(stop_positions);
+    route_distances_ = std::move(route_distances);
+}
+    
+void CatalogueSnapshot::BuildBusStats() {
+    std::vector<std::uint32_t> last_bus(columns_.GetStopCount(), 0);
+    std::vector<RouteStat> bus_stats;
+    bus_stats.reserve(columns_.GetBusCount());
+    
+    for (size_t bus_id = 0; bus_id != columns_.GetBusCount(); ++bus_id) {
+        int unique_stop_count = 0;
+        for (auto stop_id: columns_.GetBusRoute(bus_id)) {
+            if (last_bus[stop_id] != bus_id + 1) {
+                last_bus[stop_id] = bus_id + 1;
+                ++unique_stop_count;
+            }
+        }
+        
+        const auto route = columns_.GetBusFullRoute(bus_id);
+        if (route.empty()) {
+            bus_stats.push_back({0, 0, 0., 0.});
+            continue;
+        }
+        
+        auto geo_distance = std::transform_reduce(
+            route.begin() + 1,
+            route.end(),
+            route.begin(),
+            0.,
+            std::plus<>(),
+            [this](auto next, auto prev) {
+                return geo::ComputeDistance(columns_.GetStopCoordinates(prev), columns_.GetStopCoordinates(next));
+            });
+        
+        auto real_distance = std::transform_reduce(
+            route.begin() + 1,
+            route.end(),
+            route.begin(),
+            0.,
+            std::plus<>(),
+            [this](auto next, auto prev) {
+                return GetDistanceBetweenStops(prev, next);
+            });
+        
+        auto curvature = real_distance / geo_distance;
+        bus_stats.push_back({static_cast<int>(route.size()), unique_stop_count, real_distance, curvature});
+    }
+    bus_stats_ = std::move(bus_stats);
+}
+}
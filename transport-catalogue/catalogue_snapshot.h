@@ -0,0 +1,124 @@
+#pragma once
+
+#include "geo.h"
+#include "domain.h"
+#include "catalogue_columns.h"
+#include "column.h"
+#include "name_prefix_index.h"
+#include "perfect_hash.h"
+#include "stop_spatial_index.h"
+#include "ranges.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace transport_catalogue {
+    
+class TransportCatalogue;
+    
+struct RoadDistance {
+    std::uint32_t to;
+    int distance;
+};
+    
+struct StopPosition {
+    std::uint32_t stop;
+    std::uint32_t position;
+};
+    
+struct RouteStat {
+    int stop_count;
+    int unique_stop_count;
+    double route_length;
+    double curvature;
+};
+    
+// Неизменяемый снимок справочника, который строит TransportCatalogue::Freeze().
+// Данные лежат в колонках, все индексы построены заранее, а методы только читают,
+// поэтому снимок можно опрашивать из любого числа потоков без блокировок
+class CatalogueSnapshot {
+public:
+    using RoadDistancesRange = ranges::Range<const RoadDistance*>;
+    
+    explicit CatalogueSnapshot(const TransportCatalogue& catalogue);
+    
+    std::optional<size_t> FindStop(std::string_view name) const;
+    std::optional<size_t> FindBus(std::string_view name) const;
+    std::optional<domain::StopStat> GetStopStat(std::string_view name) const;
+    std::optional<domain::BusStat> GetBusStat(std::string_view name) const;
+    
+    double GetDistanceBetweenStops(size_t from_id, size_t to_id) const;
+    // Заданные в базе расстояния от остановки, упорядоченные по id остановки назначения
+    RoadDistancesRange GetRoadDistances(size_t from_id) const;
+    
+    // Автобусы, идущие от from до to без пересадок, в порядке имён. Для каждого выбирается ближайшая по
+    // маршруту пара остановок. nullopt, если одной из остановок нет в справочнике
+    std::optional<std::vector<domain::DirectBus>> FindDirectBuses(std::string_view from, std::string_view to) const;
+    
+    // Не более count ближайших к точке остановок в радиусе max_distance метров
+    std::vector<domain::NearbyStop> FindNearestStops(geo::Coordinates point, size_t count, double max_distance) const;
+    // Имена остановок внутри прямоугольника, в алфавитном порядке
+    std::vector<std::string_view> FindStopsInBox(geo::Coordinates min, geo::Coordinates max) const;
+    
+    // Не более count имён остановок и не более count имён автобусов, начинающихся с prefix, в алфавитном порядке
+    domain::Suggestions Suggest(std::string_view prefix, size_t count) const;
+    
+    std::vector<geo::Coordinates> GetStopsCoordinates() const;
+    domain::MapStat GetRoutesMapStat() const;
+    
+    const CatalogueColumns& GetColumns() const;
+    const perfect_hash::NameIndex& GetStopNameIndex() const;
+    const perfect_hash::NameIndex& GetBusNameIndex() const;
+    const NamePrefixIndex& GetStopPrefixIndex() const;
+    const NamePrefixIndex& GetBusPrefixIndex() const;
+    const StopSpatialIndex& GetStopSpatialIndex() const;
+    
+private:
+    // Файл базы читает и пишет данные снимка напрямую
+    friend class BaseImage;
+    
+    // Владелец памяти, на которую ссылаются колонки снимка, прочитанного из файла базы
+    std::shared_ptr<const void> storage_;
+    
+    CatalogueColumns columns_;
+    perfect_hash::NameIndex stop_name_index_;
+    perfect_hash::NameIndex bus_name_index_;
+    // Упорядочения имён: по ним идут выдачи в алфавитном порядке и поиск по префиксу
+    NamePrefixIndex stop_prefix_index_;
+    NamePrefixIndex bus_prefix_index_;
+    StopSpatialIndex stop_spatial_index_;
+    
+    // CSR-индекс остановка -> автобусы: id автобусов остановки stop_id лежат в
+    // stop_buses_[stop_buses_offsets_[stop_id], stop_buses_offsets_[stop_id + 1]) в порядке имён
+    storage::Column<std::uint32_t> stop_buses_offsets_;
+    storage::Column<std::uint32_t> stop_buses_;
+    
+    // Расстояния по дорогам в том же CSR-виде, по остановке отправления
+    storage::Column<std::uint32_t> road_distances_offsets_;
+    storage::Column<RoadDistance> road_distances_;
+    
+    // Индекс позиций остановок в полных маршрутах: для автобуса bus_id пары {остановка, позиция} лежат в
+    // bus_stop_positions_[bus_positions_offsets_[bus_id], bus_positions_offsets_[bus_id + 1]) по возрастанию
+    // остановки и позиции, а route_distances_ в тех же границах хранит путь от начала маршрута до каждой позиции
+    storage::Column<std::uint32_t> bus_positions_offsets_;
+    storage::Column<StopPosition> bus_stop_positions_;
+    storage::Column<double> route_distances_;
+    
+    // Статистика маршрутов не меняется после заморозки и считается один раз
+    storage::Column<RouteStat> bus_stats_;
+    
+    CatalogueSnapshot() = default;
+    
+    bool HasBuses(size_t stop_id) const;
+    std::optional<int> FindRoadDistance(size_t from_id, size_t to_id) const;
+    ranges::Range<const StopPosition*> GetStopPositions(size_t bus_id, size_t stop_id) const;
+    
+    void BuildStopToBusesIndex();
+    void BuildRoadDistances(const TransportCatalogue& catalogue);
+    void BuildBusPositions();
+    void BuildBusStats();
+};
+}
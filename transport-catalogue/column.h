@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace storage {
+
+// Неизменяемый массив данных справочника. Либо владеет значениями, либо ссылается на чужую
+// память, например на отображённый в память файл базы. Во втором случае владелец памяти
+// должен жить дольше массива и всех его копий
+template <typename T>
+class Column {
+public:
+    Column() = default;
+
+    Column(std::vector<T> values)
+        : values_(std::move(values))
+        , data_(values_.data())
+        , size_(values_.size()) {
+    }
+
+    Column(const T* data, size_t size)
+        : data_(data)
+        , size_(size)
+        , is_view_(true) {
+    }
+
+    Column(const Column& other)
+        : values_(other.values_)
+        , data_(other.is_view_ ? other.data_ : values_.data())
+        , size_(other.size_)
+        , is_view_(other.is_view_) {
+    }
+
+    // Перемещение вектора не меняет адрес его данных, поэтому data_ остаётся верным в обоих случаях
+    Column(Column&& other) noexcept
+        : values_(std::move(other.values_))
+        , data_(std::exchange(other.data_, nullptr))
+        , size_(std::exchange(other.size_, 0))
+        , is_view_(other.is_view_) {
+    }
+
+    Column& operator=(Column other) noexcept {
+        values_ = std::move(other.values_);
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        is_view_ = other.is_view_;
+        return *this;
+    }
+
+    const T* data() const {
+        return data_;
+    }
+    size_t size() const {
+        return size_;
+    }
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    const T* begin() const {
+        return data_;
+    }
+    const T* end() const {
+        return data_ + size_;
+    }
+
+    const T& operator[](size_t index) const {
+        return data_[index];
+    }
+    const T& back() const {
+        return data_[size_ - 1];
+    }
+
+private:
+    std::vector<T> values_;
+    const T* data_ = nullptr;
+    size_t size_ = 0;
+    bool is_view_ = false;
+};
+
+// Проверки массивов, прочитанных из файла базы, до того как ими индексируются другие массивы.
+// Подходят и для колонок, и для повторяющихся полей protobuf
+
+// Смещения CSR-массива из count отрезков: count + 1 неубывающих значений от first до last
+template <typename Offsets>
+bool IsValidOffsets(const Offsets& offsets, size_t count, size_t first, size_t last) {
+    if (static_cast<size_t>(std::distance(offsets.begin(), offsets.end())) != count + 1 || *offsets.begin() != first) {
+        return false;
+    }
+    return std::is_sorted(offsets.begin(), offsets.end()) && *std::prev(offsets.end()) == last;
+}
+
+// Все номера меньше count
+template <typename Ids>
+bool AreIdsBelow(const Ids& ids, size_t count) {
+    return std::all_of(ids.begin(), ids.end(), [count](auto id) {
+        return static_cast<size_t>(id) < count;
+    });
+}
+}
@@ -20,18 +20,19 @@ namespace detail {
 std::size_t StopPairHasher::operator()(const std::pair<const Stop*, const Stop*>& stop_pair) const {
     return std::hash<const void*>{}(stop_pair.first) + 37 * std::hash<const void*>{}(stop_pair.second);
 }
-    
-bool BusPtrCompare::operator()(const Bus* lhs, const Bus* rhs) const {
-    return lhs->name < rhs->name;
 }
     
-bool StopPtrCompare::operator()(const Stop* lhs, const Stop* rhs) const {
-    return lhs->name < rhs->name;
+Stop::Stop(std::string name, double lat, double lng, size_t id)
+    : name(name)
+    , coordinates{lat, lng}
+    , id(id) {
 }
+    
+Bus::FullRoute Bus::GetFullRoute() const {
+    return {route.begin(), route.end(), is_roundtrip};
 }
     
-Stop::Stop(std::string name, double lat, double lng)
-    : name(name)
-    , coordinates{lat, lng} {
+MapStat::BusItem::FullRoute MapStat::BusItem::GetFullRoute() const {
+    return {route.begin(), route.end(), is_roundtrip};
 }
 }
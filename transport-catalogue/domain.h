@@ -1,13 +1,15 @@
 #pragma once
 
 #include "geo.h"
+#include "ranges.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <string>
 #include <vector>
 #include <unordered_map>
-#include <set>
 #include <string_view>
-#include <map>
 
 namespace domain { 
 struct Stop;
@@ -17,57 +19,225 @@ namespace detail {
 struct StopPairHasher {
     std::size_t operator()(const std::pair<const Stop*, const Stop*>& stop_pair) const;
 };
+}
     
-struct BusPtrCompare {
-    bool operator()(const Bus* lhs, const Bus* rhs) const;
-};
+// Полный путь автобуса поверх остановок, хранимых один раз: у некольцевого маршрута
+// за прямым проходом виртуально следует обратный, без повторного хранения остановок
+template <typename It>
+class RouteView {
+public:
+    using ValueType = typename std::iterator_traits<It>::value_type;
+    
+    class Iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = ValueType;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = ValueType;
+        
+        Iterator() = default;
+        Iterator(It stops, size_t stored_size, difference_type index)
+            : stops_(stops)
+            , stored_size_(stored_size)
+            , index_(index) {
+        }
+        
+        reference operator*() const {
+            return At(stops_, stored_size_, index_);
+        }
+        reference operator[](difference_type n) const {
+            return At(stops_, stored_size_, index_ + n);
+        }
+        
+        Iterator& operator++() {
+            ++index_;
+            return *this;
+        }
+        Iterator operator++(int) {
+            auto copy = *this;
+            ++index_;
+            return copy;
+        }
+        Iterator& operator--() {
+            --index_;
+            return *this;
+        }
+        Iterator operator--(int) {
+            auto copy = *this;
+            --index_;
+            return copy;
+        }
+        Iterator& operator+=(difference_type n) {
+            index_ += n;
+            return *this;
+        }
+        Iterator& operator-=(difference_type n) {
+            index_ -= n;
+            return *this;
+        }
+        
+        friend Iterator operator+(Iterator it, difference_type n) {
+            return it += n;
+        }
+        friend Iterator operator+(difference_type n, Iterator it) {
+            return it += n;
+        }
+        friend Iterator operator-(Iterator it, difference_type n) {
+            return it -= n;
+        }
+        friend difference_type operator-(const Iterator& lhs, const Iterator& rhs) {
+            return lhs.index_ - rhs.index_;
+        }
+        
+        friend bool operator==(const Iterator& lhs, const Iterator& rhs) {
+            return lhs.index_ == rhs.index_;
+        }
+        friend bool operator!=(const Iterator& lhs, const Iterator& rhs) {
+            return lhs.index_ != rhs.index_;
+        }
+        friend bool operator<(const Iterator& lhs, const Iterator& rhs) {
+            return lhs.index_ < rhs.index_;
+        }
+        friend bool operator>(const Iterator& lhs, const Iterator& rhs) {
+            return lhs.index_ > rhs.index_;
+        }
+        friend bool operator<=(const Iterator& lhs, const Iterator& rhs) {
+            return lhs.index_ <= rhs.index_;
+        }
+        friend bool operator>=(const Iterator& lhs, const Iterator& rhs) {
+            return lhs.index_ >= rhs.index_;
+        }
+        
+    private:
+        It stops_{};
+        size_t stored_size_ = 0;
+        difference_type index_ = 0;
+    };
+    
+    RouteView(It begin, It end, bool is_roundtrip)
+        : begin_(begin)
+        , stored_size_(std::distance(begin, end))
+        , is_roundtrip_(is_roundtrip) {
+    }
+    
+    size_t size() const {
+        return is_roundtrip_ || stored_size_ == 0 ? stored_size_ : stored_size_ * 2 - 1;
+    }
+    bool empty() const {
+        return stored_size_ == 0;
+    }
+    ValueType operator[](size_t index) const {
+        return At(begin_, stored_size_, index);
+    }
+    Iterator begin() const {
+        return {begin_, stored_size_, 0};
+    }
+    Iterator end() const {
+        return {begin_, stored_size_, static_cast<std::ptrdiff_t>(size())};
+    }
+    
+private:
+    It begin_;
+    size_t stored_size_;
+    bool is_roundtrip_;
     
-struct StopPtrCompare {
-    bool operator()(const Stop* lhs, const Stop* rhs) const;
+    static ValueType At(It stops, size_t stored_size, size_t index) {
+        return index < stored_size ? stops[index] : stops[stored_size * 2 - 2 - index];
+    }
 };
-}
     
 struct Stop {
     std::string name;
     geo::Coordinates coordinates; 
+    size_t id;
     
-    Stop(std::string name, double lat, double lng);
+    Stop(std::string name, double lat, double lng, size_t id);
 };
 
+// У некольцевого маршрута в route хранится только прямой проход, полный путь даёт GetFullRoute()
 struct Bus {
+    using FullRoute = RouteView<std::vector<const Stop*>::const_iterator>;
+    
     std::string name;
     std::vector<const Stop*> route;
     bool is_roundtrip;
+    
+    FullRoute GetFullRoute() const;
 };
 
 struct BusStat {
-    std::string name;
+    std::string_view name;
     int stop_count;
     int unique_stop_count;
     double route_length;
     double curvature;
 };
     
+// Не владеет данными: buses указывает на участок индекса справочника с id автобусов,
+// отсортированными по имени автобуса
 struct StopStat {
-    std::string name;
-    std::set<std::string_view> buses;
+    std::string_view name;
+    ranges::Range<const std::uint32_t*> buses;
 };
     
+// Остановки, через которые проходят автобусы, и непустые маршруты, упорядоченные по имени.
+// Маршрут хранится один раз и задан номерами остановок в stops
 struct MapStat {
-    const std::set<const Bus*, detail::BusPtrCompare> buses;
-    const std::set<const Stop*, detail::StopPtrCompare> stops;
+    struct StopItem {
+        std::string_view name;
+        geo::Coordinates coordinates;
+    };
+    
+    struct BusItem {
+        using FullRoute = RouteView<std::vector<size_t>::const_iterator>;
+        
+        std::string_view name;
+        std::vector<size_t> route;
+        bool is_roundtrip;
+        
+        FullRoute GetFullRoute() const;
+    };
+    
+    std::vector<StopItem> stops;
+    std::vector<BusItem> buses;
+};
+    
+// Автобус, который везёт между двумя остановками без пересадок. distance - путь по дорогам
+struct DirectBus {
+    std::string_view bus;
+    int span_count;
+    double distance;
 };
     
+struct Suggestions {
+    std::vector<std::string_view> stops;
+    std::vector<std::string_view> buses;
+};
+    
+struct NearbyStop {
+    std::string_view name;
+    double distance;
+};
+    
+// Имена в запросах ссылаются на разобранный вход и должны жить, пока запросы обрабатываются.
+// Копируются они только в сам справочник
 struct BusBaseRequest {
-    std::string name;
-    std::vector<std::string> stops;
+    std::string_view name;
+    std::vector<std::string_view> stops;
     bool is_roundtrip;
 };
     
 struct StopBaseRequest {
-    std::string name;
+    std::string_view name;
     double lat;
     double lng;
-    std::unordered_map<std::string, int> distances;
+    std::unordered_map<std::string_view, int> distances;
+};
+    
+struct RoadDistanceBaseRequest {
+    std::string_view from;
+    std::string_view to;
+    int distance;
 };
 }
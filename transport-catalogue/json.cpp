@@ -1,225 +1,544 @@
 #include "json.h"
 
-#include <iterator>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <new>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define JSON_HAS_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define JSON_HAS_SSE2
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 namespace json {
 
 namespace {
 using namespace std::literals;
 
-Node LoadNode(std::istream& input);
-Node LoadString(std::istream& input);
+// Сканеры ищут в буфере следующий символ, на котором разбору нужно остановиться, сразу по 32 или 16 байт.
+// Маска совпадений из сравнения блока даёт номер первого такого символа. Хвост короче блока
+// и сборки без SSE2 обрабатываются посимвольно
+namespace scan {
 
-std::string LoadLiteral(std::istream& input) {
-    std::string s;
-    while (std::isalpha(input.peek())) {
-        s.push_back(static_cast<char>(input.get()));
-    }
-    return s;
+inline bool IsStringSpecial(char c) {
+    return c == '"' || c == '\\' || c == '\n' || c == '\r';
 }
 
-Node LoadArray(std::istream& input) {
-    std::vector<Node> result;
+inline bool IsSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
 
-    for (char c; input >> c && c != ']';) {
-        if (c != ',') {
-            input.putback(c);
+#ifdef JSON_HAS_SSE2
+inline unsigned CountTrailingZeros(std::uint32_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+// Первая кавычка, обратная косая черта или перевод строки, либо end
+inline const char* FindStringSpecial(const char* pos, const char* end) {
+#ifdef JSON_HAS_AVX2
+    const __m256i quote32 = _mm256_set1_epi8('"');
+    const __m256i backslash32 = _mm256_set1_epi8('\\');
+    const __m256i line_feed32 = _mm256_set1_epi8('\n');
+    const __m256i carriage_return32 = _mm256_set1_epi8('\r');
+    for (; end - pos >= 32; pos += 32) {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+        const __m256i matches = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, quote32), _mm256_cmpeq_epi8(block, backslash32)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, line_feed32), _mm256_cmpeq_epi8(block, carriage_return32)));
+        if (const std::uint32_t mask = _mm256_movemask_epi8(matches)) {
+            return pos + CountTrailingZeros(mask);
         }
-        result.push_back(LoadNode(input));
     }
-    if (!input) {
-        throw ParsingError("Array parsing error"s);
+#endif
+#ifdef JSON_HAS_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i line_feed = _mm_set1_epi8('\n');
+    const __m128i carriage_return = _mm_set1_epi8('\r');
+    for (; end - pos >= 16; pos += 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+        const __m128i matches = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash)),
+            _mm_or_si128(_mm_cmpeq_epi8(block, line_feed), _mm_cmpeq_epi8(block, carriage_return)));
+        if (const std::uint32_t mask = _mm_movemask_epi8(matches)) {
+            return pos + CountTrailingZeros(mask);
+        }
+    }
+#endif
+    while (pos != end && !IsStringSpecial(*pos)) {
+        ++pos;
     }
-    return Node(std::move(result));
+    return pos;
 }
 
-Node LoadDict(std::istream& input) {
-    Dict dict;
+// Первый непробельный символ, либо end. Между значениями обычно не больше пары пробелов,
+// поэтому блоки сравниваются, только если пробельный символ идёт не один
+inline const char* SkipSpaces(const char* pos, const char* end) {
+    if (pos == end || !IsSpace(*pos)) {
+        return pos;
+    }
+    ++pos;
+#ifdef JSON_HAS_SSE2
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i line_feed = _mm_set1_epi8('\n');
+    const __m128i carriage_return = _mm_set1_epi8('\r');
+    // \t, \v и \f идут в таблице подряд (9, 11, 12), поэтому к ним добавлен и \n (10)
+    const __m128i tab_minus_one = _mm_set1_epi8('\t' - 1);
+    const __m128i form_feed_plus_one = _mm_set1_epi8('\f' + 1);
+    while (end - pos >= 16 && IsSpace(*pos)) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+        const __m128i in_tab_range = _mm_and_si128(_mm_cmpgt_epi8(block, tab_minus_one), _mm_cmplt_epi8(block, form_feed_plus_one));
+        const __m128i spaces = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, space), in_tab_range),
+                                            _mm_or_si128(_mm_cmpeq_epi8(block, line_feed), _mm_cmpeq_epi8(block, carriage_return)));
+        const std::uint32_t mask = ~static_cast<std::uint32_t>(_mm_movemask_epi8(spaces)) & 0xFFFF;
+        if (mask) {
+            return pos + CountTrailingZeros(mask);
+        }
+        pos += 16;
+    }
+#endif
+    while (pos != end && IsSpace(*pos)) {
+        ++pos;
+    }
+    return pos;
+}
 
-    for (char c; input >> c && c != '}';) {
-        if (c == '"') {
-            std::string key = LoadString(input).AsString();
-            if (input >> c && c == ':') {
-                if (dict.find(key) != dict.end()) {
-                    throw ParsingError("Duplicate key '"s + key + "' have been found");
-                }
-                dict.emplace(std::move(key), LoadNode(input));
-            } else {
-                throw ParsingError(": is expected but '"s + c + "' has been found"s);
+}  // namespace scan
+
+// До такого размера словаря ключ ищется простым перебором, это быстрее двоичного поиска
+const size_t DICT_LINEAR_SEARCH_SIZE = 8;
+
+// Первый элемент с ключом не меньше key среди упорядоченных по ключу. Ключ элемента возвращает get_key
+template <typename Iterator, typename KeyGetter>
+Iterator FindKeyPosition(Iterator first, Iterator last, std::string_view key, KeyGetter get_key) {
+    if (static_cast<size_t>(last - first) <= DICT_LINEAR_SEARCH_SIZE) {
+        while (first != last && get_key(*first) < key) {
+            ++first;
+        }
+        return first;
+    }
+    return std::lower_bound(first, last, key, [&get_key](const auto& item, std::string_view key) {
+        return get_key(item) < key;
+    });
+}
+
+// Разбирает JSON из непрерывного буфера, продвигая указатель на текущий символ.
+// Ошибки и дерево узлов те же, что давал разбор прямо из потока.
+// Элементы массивов и пары словарей сначала складываются в общие стеки разбора,
+// а готовый массив или словарь получает память ровно под свой размер одним выделением из resource.
+// Пары словаря лежат в стеке в порядке чтения, а по ключу упорядочиваются их номера в key_order_:
+// так повтор ключа находится сразу, а пары не переставляются
+class Parser {
+public:
+    // in_situ_text - тот же текст, что и [begin, end), но изменяемый. Если он задан, строки
+    // раскодируются прямо в нём и узлы ссылаются на него, а не копируют строки
+    Parser(const char* begin, const char* end, std::pmr::memory_resource* resource, char* in_situ_text = nullptr)
+        : begin_(begin)
+        , pos_(begin)
+        , end_(end)
+        , in_situ_text_(in_situ_text)
+        , allocator_(resource) {
+    }
+
+    Node LoadNode() {
+        char c;
+        if (!ReadChar(c)) {
+            throw ParsingError("Unexpected EOF"s);
+        }
+        switch (c) {
+            case '[':
+                return LoadArray();
+            case '{':
+                return LoadDict();
+            case '"':
+                return LoadString();
+            case 't':
+                // Встретив t или f, переходим к попытке парсинга литералов true либо false
+                [[fallthrough]];
+            case 'f':
+                --pos_;
+                return LoadBool();
+            case 'n':
+                --pos_;
+                return LoadNull();
+            default:
+                --pos_;
+                return LoadNumber();
+        }
+    }
+
+private:
+    const char* begin_;
+    const char* pos_;
+    const char* end_;
+    char* in_situ_text_;
+    std::pmr::polymorphic_allocator<Node> allocator_;
+    std::vector<Node> items_;
+    std::vector<Dict::value_type> entries_;
+    std::vector<uint32_t> key_order_;
+    std::string string_;
+
+    static bool IsDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+    static bool IsAlpha(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    }
+
+    // Как input >> c: пропускает пробельные символы и читает следующий
+    bool ReadChar(char& c) {
+        pos_ = scan::SkipSpaces(pos_, end_);
+        if (pos_ == end_) {
+            return false;
+        }
+        c = *pos_++;
+        return true;
+    }
+
+    // Как input.peek(): следующий символ или EOF
+    int Peek() const {
+        return pos_ != end_ ? static_cast<unsigned char>(*pos_) : std::char_traits<char>::eof();
+    }
+
+    std::string_view LoadLiteral() {
+        const char* begin = pos_;
+        while (pos_ != end_ && IsAlpha(*pos_)) {
+            ++pos_;
+        }
+        return {begin, static_cast<size_t>(pos_ - begin)};
+    }
+
+    Node LoadArray() {
+        const size_t first_item = items_.size();
+
+        char c;
+        bool is_closed = false;
+        while (ReadChar(c)) {
+            if (c == ']') {
+                is_closed = true;
+                break;
+            }
+            if (c != ',') {
+                --pos_;
             }
-        } else if (c != ',') {
-            throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+            items_.push_back(LoadNode());
+        }
+        if (!is_closed) {
+            throw ParsingError("Array parsing error"s);
         }
+        Array result(std::make_move_iterator(items_.begin() + first_item), std::make_move_iterator(items_.end()), allocator_);
+        items_.resize(first_item);
+        return Node(std::move(result));
     }
-    if (!input) {
-        throw ParsingError("Dictionary parsing error"s);
+
+    Node LoadDict() {
+        const size_t first_entry = entries_.size();
+
+        char c;
+        bool is_closed = false;
+        while (ReadChar(c)) {
+            if (c == '}') {
+                is_closed = true;
+                break;
+            }
+            if (c == '"') {
+                std::pmr::string key(ReadString(), allocator_);
+                if (ReadChar(c) && c == ':') {
+                    const auto get_key = [this](uint32_t index) -> std::string_view {
+                        return entries_[index].first;
+                    };
+                    const auto position = FindKeyPosition(key_order_.begin() + first_entry, key_order_.end(), key, get_key);
+                    if (position != key_order_.end() && get_key(*position) == key) {
+                        throw ParsingError("Duplicate key '"s + std::string{key} + "' have been found");
+                    }
+                    key_order_.insert(position, static_cast<uint32_t>(entries_.size()));
+                    entries_.emplace_back(std::move(key), Node{});
+                    // Вложенные значения добавляют в стек свои пары и убирают их, так что место этой пары не меняется
+                    const size_t index = entries_.size() - 1;
+                    entries_[index].second = LoadNode();
+                } else {
+                    throw ParsingError(": is expected but '"s + c + "' has been found"s);
+                }
+            } else if (c != ',') {
+                throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+            }
+        }
+        if (!is_closed) {
+            throw ParsingError("Dictionary parsing error"s);
+        }
+        Dict dict(allocator_);
+        dict.reserve(entries_.size() - first_entry);
+        for (auto it = key_order_.begin() + first_entry; it != key_order_.end(); ++it) {
+            dict.try_emplace(std::move(entries_[*it].first), std::move(entries_[*it].second));
+        }
+        entries_.resize(first_entry);
+        key_order_.resize(first_entry);
+        return Node(std::move(dict));
     }
-    return Node(std::move(dict));
-}
 
-Node LoadString(std::istream& input) {
-    auto it = std::istreambuf_iterator<char>(input);
-    auto end = std::istreambuf_iterator<char>();
-    std::string s;
-    while (true) {
-        if (it == end) {
-            throw ParsingError("String parsing error");
+    Node LoadString() {
+        const auto text = ReadString();
+        if (in_situ_text_) {
+            void* view_memory = allocator_.resource()->allocate(sizeof(std::string_view), alignof(std::string_view));
+            return Node(StringRef{new (view_memory) std::string_view(text)});
         }
-        const char ch = *it;
-        if (ch == '"') {
-            ++it;
-            break;
-        } else if (ch == '\\') {
-            ++it;
-            if (it == end) {
+        return Node(std::pmr::string(text, allocator_));
+    }
+
+    // При разборе на месте строка остаётся в тексте документа: экранированные символы раскодируются
+    // в нём же, а остаток строки сдвигается к её началу. Строка без экранирования не переписывается.
+    // Иначе строка собирается в общем буфере разбора и действительна до следующего вызова
+    std::string_view ReadString() {
+        char* const out_begin = in_situ_text_ ? in_situ_text_ + (pos_ - begin_) : nullptr;
+        char* out = out_begin;
+        string_.clear();
+        const auto append = [this, &out](const char* run_begin, const char* run_end) {
+            if (!out) {
+                string_.append(run_begin, run_end);
+                return;
+            }
+            if (out != run_begin) {
+                std::memmove(out, run_begin, run_end - run_begin);
+            }
+            out += run_end - run_begin;
+        };
+        const auto push_back = [this, &out](char c) {
+            if (out) {
+                *out++ = c;
+            } else {
+                string_.push_back(c);
+            }
+        };
+
+        while (true) {
+            const char* run_begin = pos_;
+            pos_ = scan::FindStringSpecial(pos_, end_);
+            append(run_begin, pos_);
+            
+            if (pos_ == end_) {
                 throw ParsingError("String parsing error");
             }
-            const char escaped_char = *(it);
-            switch (escaped_char) {
-                case 'n':
-                    s.push_back('\n');
-                    break;
-                case 't':
-                    s.push_back('\t');
-                    break;
-                case 'r':
-                    s.push_back('\r');
-                    break;
-                case '"':
-                    s.push_back('"');
-                    break;
-                case '\\':
-                    s.push_back('\\');
-                    break;
-                default:
-                    throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
+            const char ch = *pos_++;
+            if (ch == '"') {
+                break;
+            } else if (ch == '\\') {
+                if (pos_ == end_) {
+                    throw ParsingError("String parsing error");
+                }
+                const char escaped_char = *pos_++;
+                switch (escaped_char) {
+                    case 'n':
+                        push_back('\n');
+                        break;
+                    case 't':
+                        push_back('\t');
+                        break;
+                    case 'r':
+                        push_back('\r');
+                        break;
+                    case '"':
+                        push_back('"');
+                        break;
+                    case '\\':
+                        push_back('\\');
+                        break;
+                    default:
+                        throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
+                }
+            } else {
+                throw ParsingError("Unexpected end of line"s);
             }
-        } else if (ch == '\n' || ch == '\r') {
-            throw ParsingError("Unexpected end of line"s);
-        } else {
-            s.push_back(ch);
         }
-        ++it;
-    }
 
-    return Node(std::move(s));
-}
+        if (out) {
+            return {out_begin, static_cast<size_t>(out - out_begin)};
+        }
+        return string_;
+    }
 
-Node LoadBool(std::istream& input) {
-    const auto s = LoadLiteral(input);
-    if (s == "true"sv) {
-        return Node{true};
-    } else if (s == "false"sv) {
-        return Node{false};
-    } else {
-        throw ParsingError("Failed to parse '"s + s + "' as bool"s);
+    Node LoadBool() {
+        const auto s = LoadLiteral();
+        if (s == "true"sv) {
+            return Node{true};
+        } else if (s == "false"sv) {
+            return Node{false};
+        } else {
+            throw ParsingError("Failed to parse '"s + std::string{s} + "' as bool"s);
+        }
     }
-}
 
-Node LoadNull(std::istream& input) {
-    if (auto literal = LoadLiteral(input); literal == "null"sv) {
-        return Node{nullptr};
-    } else {
-        throw ParsingError("Failed to parse '"s + literal + "' as null"s);
+    Node LoadNull() {
+        if (auto literal = LoadLiteral(); literal == "null"sv) {
+            return Node{nullptr};
+        } else {
+            throw ParsingError("Failed to parse '"s + std::string{literal} + "' as null"s);
+        }
     }
-}
 
-Node LoadNumber(std::istream& input) {
-    std::string parsed_num;
+    Node LoadNumber() {
+        const char* begin = pos_;
+
+        // Считывает одну или более цифр
+        auto read_digits = [this] {
+            if (pos_ == end_ || !IsDigit(*pos_)) {
+                throw ParsingError("A digit is expected"s);
+            }
+            while (pos_ != end_ && IsDigit(*pos_)) {
+                ++pos_;
+            }
+        };
+
+        if (Peek() == '-') {
+            ++pos_;
+        }
+        // Парсим целую часть числа
+        if (Peek() == '0') {
+            ++pos_;
+            // После 0 в JSON не могут идти другие цифры
+        } else {
+            read_digits();
+        }
 
-    // Считывает в parsed_num очередной символ из input
-    auto read_char = [&parsed_num, &input] {
-        parsed_num += static_cast<char>(input.get());
-        if (!input) {
-            throw ParsingError("Failed to read number from stream"s);
+        bool is_int = true;
+        // Парсим дробную часть числа
+        if (Peek() == '.') {
+            ++pos_;
+            read_digits();
+            is_int = false;
         }
-    };
 
-    // Считывает одну или более цифр в parsed_num из input
-    auto read_digits = [&input, read_char] {
-        if (!std::isdigit(input.peek())) {
-            throw ParsingError("A digit is expected"s);
+        // Парсим экспоненциальную часть числа
+        if (int ch = Peek(); ch == 'e' || ch == 'E') {
+            ++pos_;
+            if (ch = Peek(); ch == '+' || ch == '-') {
+                ++pos_;
+            }
+            read_digits();
+            is_int = false;
+        }
+
+        // Текст числа уже проверен по грамматике JSON, поэтому from_chars разбирает его прямо в буфере.
+        // Целое, которое не помещается в int, читается как double
+        if (is_int) {
+            int int_value = 0;
+            if (auto [ptr, ec] = std::from_chars(begin, pos_, int_value); ec == std::errc{} && ptr == pos_) {
+                return int_value;
+            }
+        }
+        double value = 0.0;
+        if (auto [ptr, ec] = std::from_chars(begin, pos_, value); ec != std::errc{} || ptr != pos_) {
+            throw ParsingError("Failed to convert "s + std::string(begin, pos_) + " to number"s);
         }
-        while (std::isdigit(input.peek())) {
-            read_char();
+        return value;
+    }
+};
+
+// Забирает из потока текст ровно одного значения верхнего уровня, не трогая то, что идёт после него,
+// чтобы из одного потока можно было читать документы один за другим. Сам текст здесь не проверяется:
+// скобки считаются без различия вида, а ошибки находит разбор буфера
+std::string ReadValueText(std::istream& input) {
+    std::string text;
+    std::streambuf& buf = *input.rdbuf();
+    const auto eof = std::char_traits<char>::eof();
+
+    auto next = [&] {
+        const int ch = buf.sbumpc();
+        if (ch == eof) {
+            input.setstate(std::ios::eofbit);
+        } else {
+            text.push_back(static_cast<char>(ch));
         }
+        return ch;
     };
 
-    if (input.peek() == '-') {
-        read_char();
+    int ch = buf.sgetc();
+    while (ch != eof && std::isspace(ch)) {
+        buf.sbumpc();
+        ch = buf.sgetc();
     }
-    // Парсим целую часть числа
-    if (input.peek() == '0') {
-        read_char();
-        // После 0 в JSON не могут идти другие цифры
-    } else {
-        read_digits();
+    if (ch == eof) {
+        input.setstate(std::ios::eofbit);
+        return text;
     }
 
-    bool is_int = true;
-    // Парсим дробную часть числа
-    if (input.peek() == '.') {
-        read_char();
-        read_digits();
-        is_int = false;
+    // Число или литерал забираются по тем же правилам, по которым их читает разбор
+    auto take_if = [&](auto predicate) {
+        if (const int ch = buf.sgetc(); ch != eof && predicate(ch)) {
+            next();
+            return true;
+        }
+        return false;
+    };
+    auto take_digits = [&] {
+        while (take_if([](int ch) { return std::isdigit(ch); })) {
+        }
+    };
+    if (std::isalpha(ch)) {
+        while (take_if([](int ch) { return std::isalpha(ch); })) {
+        }
+        return text;
     }
-
-    // Парсим экспоненциальную часть числа
-    if (int ch = input.peek(); ch == 'e' || ch == 'E') {
-        read_char();
-        if (ch = input.peek(); ch == '+' || ch == '-') {
-            read_char();
+    if (ch != '[' && ch != '{' && ch != '"') {
+        take_if([](int ch) { return ch == '-'; });
+        if (!take_if([](int ch) { return ch == '0'; })) {
+            take_digits();
+        }
+        if (take_if([](int ch) { return ch == '.'; })) {
+            take_digits();
+        }
+        if (take_if([](int ch) { return ch == 'e' || ch == 'E'; })) {
+            take_if([](int ch) { return ch == '+' || ch == '-'; });
+            take_digits();
         }
-        read_digits();
-        is_int = false;
+        // Символ, с которого не может начинаться значение, нужен разбору для сообщения об ошибке
+        if (text.empty()) {
+            next();
+        }
+        return text;
     }
 
-    try {
-        if (is_int) {
-            // Сначала пробуем преобразовать строку в int
-            try {
-                return std::stoi(parsed_num);
-            } catch (...) {
-                // В случае неудачи, например, при переполнении
-                // код ниже попробует преобразовать строку в double
+    int depth = 0;
+    bool in_string = false;
+    while ((ch = next()) != eof) {
+        if (in_string) {
+            if (ch == '\\') {
+                next();
+            } else if (ch == '"') {
+                in_string = false;
             }
+        } else if (ch == '"') {
+            in_string = true;
+        } else if (ch == '[' || ch == '{') {
+            ++depth;
+        } else if (ch == ']' || ch == '}') {
+            --depth;
+        }
+        if (depth == 0 && !in_string) {
+            break;
         }
-        return std::stod(parsed_num);
-    } catch (...) {
-        throw ParsingError("Failed to convert "s + parsed_num + " to number"s);
-    }
-}
-
-Node LoadNode(std::istream& input) {
-    char c;
-    if (!(input >> c)) {
-        throw ParsingError("Unexpected EOF"s);
-    }
-    switch (c) {
-        case '[':
-            return LoadArray(input);
-        case '{':
-            return LoadDict(input);
-        case '"':
-            return LoadString(input);
-        case 't':
-            // Атрибут [[fallthrough]] (провалиться) ничего не делает, и является
-            // подсказкой компилятору и человеку, что здесь программист явно задумывал
-            // разрешить переход к инструкции следующей ветки case, а не случайно забыл
-            // написать break, return или throw.
-            // В данном случае, встретив t или f, переходим к попытке парсинга
-            // литералов true либо false
-            [[fallthrough]];
-        case 'f':
-            input.putback(c);
-            return LoadBool(input);
-        case 'n':
-            input.putback(c);
-            return LoadNull(input);
-        default:
-            input.putback(c);
-            return LoadNumber(input);
     }
+    return text;
 }
 
 struct PrintContext {
@@ -245,7 +564,9 @@ void PrintValue(const Value& value, const PrintContext& ctx) {
     ctx.out << value;
 }
 
-void PrintString(const std::string& value, std::ostream& out) {
+}  // namespace
+
+void PrintString(std::string_view value, std::ostream& out) {
     out.put('"');
     for (const char c : value) {
         switch (c) {
@@ -269,8 +590,34 @@ void PrintString(const std::string& value, std::ostream& out) {
     out.put('"');
 }
 
+void PrintNumber(int value, std::ostream& out) {
+    char buffer[16];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.write(buffer, result.ptr - buffer);
+}
+
+// Формат тот же, что у operator<< с настройками потока по умолчанию (%g с точностью потока)
+void PrintNumber(double value, std::ostream& out) {
+    char buffer[64];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general,
+                                      static_cast<int>(out.precision()));
+    out.write(buffer, result.ptr - buffer);
+}
+
+namespace {
+
+template <>
+void PrintValue<int>(const int& value, const PrintContext& ctx) {
+    PrintNumber(value, ctx.out);
+}
+
+template <>
+void PrintValue<double>(const double& value, const PrintContext& ctx) {
+    PrintNumber(value, ctx.out);
+}
+
 template <>
-void PrintValue<std::string>(const std::string& value, const PrintContext& ctx) {
+void PrintValue<std::string_view>(const std::string_view& value, const PrintContext& ctx) {
     PrintString(value, ctx.out);
 }
 
@@ -331,17 +678,179 @@ void PrintValue<Dict>(const Dict& nodes, const PrintContext& ctx) {
 }
 
 void PrintNode(const Node& node, const PrintContext& ctx) {
-    std::visit(
-        [&ctx](const auto& value) {
-            PrintValue(value, ctx);
-        },
-        node.GetValue());
+    node.Visit([&ctx](const auto& value) {
+        PrintValue(value, ctx);
+    });
 }
 
 }  // namespace
 
+Dict::Dict(std::initializer_list<std::pair<std::string_view, Node>> entries) {
+    entries_.reserve(entries.size());
+    for (const auto& [key, value] : entries) {
+        try_emplace(key, value);
+    }
+}
+
+size_t Dict::LowerBound(std::string_view key) const {
+    return FindKeyPosition(entries_.begin(), entries_.end(), key, [](const value_type& entry) -> std::string_view {
+        return entry.first;
+    }) - entries_.begin();
+}
+
+Dict::iterator Dict::find(std::string_view key) {
+    const size_t i = LowerBound(key);
+    return i < entries_.size() && entries_[i].first == key ? entries_.begin() + i : entries_.end();
+}
+
+Dict::const_iterator Dict::find(std::string_view key) const {
+    const size_t i = LowerBound(key);
+    return i < entries_.size() && entries_[i].first == key ? entries_.begin() + i : entries_.end();
+}
+
+const Node& Dict::at(std::string_view key) const {
+    using namespace std::literals;
+    const auto it = find(key);
+    if (it == end()) {
+        throw std::out_of_range("Key '"s + std::string{key} + "' is not found"s);
+    }
+    return it->second;
+}
+
+// Ключи во входе обычно идут по возрастанию, тогда пара просто дописывается в конец
+std::pair<Dict::iterator, bool> Dict::try_emplace(std::pmr::string key, Node value) {
+    size_t i = entries_.size();
+    if (!entries_.empty() && !(entries_.back().first < key)) {
+        i = LowerBound(key);
+        if (entries_[i].first == key) {
+            return {entries_.begin() + i, false};
+        }
+    }
+    return {entries_.emplace(entries_.begin() + i, std::move(key), std::move(value)), true};
+}
+
+Document::Document(std::unique_ptr<std::pmr::monotonic_buffer_resource> arena, Node root, std::unique_ptr<std::string> text)
+    : text_(std::move(text))
+    , arena_(std::move(arena)) {
+    void* root_memory = arena_->allocate(sizeof(Node), alignof(Node));
+    arena_root_ = new (root_memory) Node(std::move(root));
+}
+
+Document::Document(Document&& other) noexcept
+    : text_(std::move(other.text_))
+    , arena_(std::move(other.arena_))
+    , arena_root_(std::exchange(other.arena_root_, nullptr))
+    , root_(std::move(other.root_)) {
+}
+
+Document& Document::operator=(Document other) noexcept {
+    std::swap(text_, other.text_);
+    std::swap(arena_, other.arena_);
+    std::swap(arena_root_, other.arena_root_);
+    std::swap(root_, other.root_);
+    return *this;
+}
+
+namespace {
+// Первый блок арены размером с текст документа, следующие арена выделяет сама с ростом
+const size_t MIN_ARENA_SIZE = 4096;
+}
+
+Document Load(std::string_view input) {
+    auto arena = std::make_unique<std::pmr::monotonic_buffer_resource>(std::max(input.size(), MIN_ARENA_SIZE));
+    auto root = Parser(input.data(), input.data() + input.size(), arena.get()).LoadNode();
+    return Document{std::move(arena), std::move(root)};
+}
+
 Document Load(std::istream& input) {
-    return Document{LoadNode(input)};
+    return LoadInSitu(ReadValueText(input));
+}
+
+Document LoadInSitu(std::string text) {
+    auto owned_text = std::make_unique<std::string>(std::move(text));
+    auto arena = std::make_unique<std::pmr::monotonic_buffer_resource>(std::max(owned_text->size(), MIN_ARENA_SIZE));
+    char* data = owned_text->data();
+    auto root = Parser(data, data + owned_text->size(), arena.get(), data).LoadNode();
+    return Document{std::move(arena), std::move(root), std::move(owned_text)};
+}
+
+namespace {
+// Пропускает пробельные символы и возвращает следующий символ, не забирая его из потока
+int PeekNonSpace(std::istream& input) {
+    std::streambuf& buf = *input.rdbuf();
+    int ch = buf.sgetc();
+    while (ch != std::char_traits<char>::eof() && std::isspace(ch)) {
+        ch = buf.snextc();
+    }
+    return ch;
+}
+
+Node LoadValue(std::istream& input) {
+    const auto text = ReadValueText(input);
+    return Parser(text.data(), text.data() + text.size(), std::pmr::get_default_resource()).LoadNode();
+}
+}  // namespace
+
+DictReader::DictReader(std::istream& input)
+    : input_(input) {
+    if (PeekNonSpace(input_) != '{') {
+        throw ParsingError("Dictionary parsing error"s);
+    }
+    input_.rdbuf()->sbumpc();
+}
+
+std::optional<std::string> DictReader::NextKey() {
+    int ch = PeekNonSpace(input_);
+    if (ch == '}') {
+        input_.rdbuf()->sbumpc();
+        return std::nullopt;
+    }
+    if (!is_first_key_) {
+        if (ch != ',') {
+            throw ParsingError("Dictionary parsing error"s);
+        }
+        input_.rdbuf()->sbumpc();
+        ch = PeekNonSpace(input_);
+    }
+    if (ch != '"') {
+        throw ParsingError("Dictionary parsing error"s);
+    }
+    is_first_key_ = false;
+
+    auto key = std::string{LoadValue(input_).AsString()};
+    if (PeekNonSpace(input_) != ':') {
+        throw ParsingError("Dictionary parsing error"s);
+    }
+    input_.rdbuf()->sbumpc();
+    return key;
+}
+
+Node DictReader::ReadValue() {
+    return LoadValue(input_);
+}
+
+void DictReader::StartArray() {
+    if (PeekNonSpace(input_) != '[') {
+        throw ParsingError("Array parsing error"s);
+    }
+    input_.rdbuf()->sbumpc();
+    is_first_item_ = true;
+}
+
+std::optional<Node> DictReader::NextItem() {
+    int ch = PeekNonSpace(input_);
+    if (ch == ']') {
+        input_.rdbuf()->sbumpc();
+        return std::nullopt;
+    }
+    if (!is_first_item_) {
+        if (ch != ',') {
+            throw ParsingError("Array parsing error"s);
+        }
+        input_.rdbuf()->sbumpc();
+    }
+    is_first_item_ = false;
+    return LoadValue(input_);
 }
 
 void Print(const Document& doc, std::ostream& output) {
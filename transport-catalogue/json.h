@@ -1,41 +1,163 @@
 #pragma once
 
+#include <initializer_list>
 #include <iostream>
-#include <map>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <variant>
 #include <vector>
 
 namespace json {
 
 class Node;
-using Dict = std::map<std::string, Node>;
-using Array = std::vector<Node>;
+class Dict;
+using Array = std::pmr::vector<Node>;
 
 class ParsingError : public std::runtime_error {
 public:
     using runtime_error::runtime_error;
 };
 
-class Node final
-    : private std::variant<std::nullptr_t, Array, Dict, bool, int, double, std::string> {
+// Значение в отдельной памяти. Узел хранит только указатель на него, а копируется вместе со значением.
+// T - pmr-контейнер: память под него берётся из того же ресурса, что и память его элементов,
+// а копия всегда получает ресурс по умолчанию и не зависит от арены исходного документа
+template <typename T>
+class Box {
 public:
-    using variant::variant;
-    using Value = variant;
+    Box(T value) {
+        std::pmr::polymorphic_allocator<T> allocator(value.get_allocator().resource());
+        ptr_ = allocator.allocate(1);
+        new (ptr_) T(std::move(value));
+    }
+    Box(const Box& other)
+        : Box(T(*other.ptr_)) {
+    }
+    Box(Box&& other) noexcept
+        : ptr_(std::exchange(other.ptr_, nullptr)) {
+    }
+    ~Box() {
+        Reset();
+    }
+
+    Box& operator=(const Box& other) {
+        if (this != &other) {
+            *this = Box(other);
+        }
+        return *this;
+    }
+    Box& operator=(Box&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            ptr_ = std::exchange(other.ptr_, nullptr);
+        }
+        return *this;
+    }
+
+    const T& operator*() const {
+        return *ptr_;
+    }
+    T& operator*() {
+        return *ptr_;
+    }
+
+private:
+    T* ptr_ = nullptr;
+
+    void Reset() {
+        if (ptr_) {
+            std::pmr::polymorphic_allocator<T> allocator(ptr_->get_allocator().resource());
+            ptr_->~T();
+            allocator.deallocate(ptr_, 1);
+            ptr_ = nullptr;
+        }
+    }
+};
+
+// Ссылка на строку во внешнем буфере. Узел хранит только указатель на string_view, чтобы остаться
+// 16-байтным, а сам string_view и буфер со строкой должны жить дольше узла
+class StringRef {
+public:
+    explicit StringRef(const std::string_view* text)
+        : text_(text) {
+    }
+
+    operator std::string_view() const {
+        return *text_;
+    }
+
+private:
+    const std::string_view* text_;
+};
+
+// Узел занимает 16 байт: тег варианта и число либо указатель. Строки, массивы и словари лежат отдельно,
+// у разобранного документа - в его арене. Строки документа, прочитанного на месте, ссылаются в его текст
+class Node final {
+public:
+    // Значение целиком, из которого можно построить узел
+    using Value = std::variant<std::nullptr_t, Array, Dict, bool, int, double, std::string>;
+
+    Node() = default;
+    Node(std::nullptr_t) {
+    }
+    Node(Array value)
+        : value_(std::in_place_type<Box<Array>>, std::move(value)) {
+    }
+    Node(Dict value);
+    Node(bool value)
+        : value_(std::in_place_type<bool>, value) {
+    }
+    Node(int value)
+        : value_(std::in_place_type<int>, value) {
+    }
+    Node(double value)
+        : value_(std::in_place_type<double>, value) {
+    }
+    Node(std::pmr::string value)
+        : value_(std::in_place_type<Box<std::pmr::string>>, std::move(value)) {
+    }
+    Node(const std::string& value)
+        : Node(std::pmr::string{value}) {
+    }
+    Node(std::string_view value)
+        : Node(std::pmr::string{value}) {
+    }
+    Node(const char* value)
+        : Node(std::pmr::string{value}) {
+    }
+    Node(StringRef value)
+        : value_(std::in_place_type<StringRef>, value) {
+    }
+
+    // Копия владеет своими строками, даже если исходный узел ссылался на текст документа
+    Node(const Node& other);
+    Node(Node&&) noexcept = default;
+    Node& operator=(const Node& other) {
+        if (this != &other) {
+            *this = Node(other);
+        }
+        return *this;
+    }
+    Node& operator=(Node&&) noexcept = default;
 
     bool IsInt() const {
-        return std::holds_alternative<int>(*this);
+        return std::holds_alternative<int>(value_);
     }
     int AsInt() const {
         using namespace std::literals;
         if (!IsInt()) {
             throw std::logic_error("Not an int"s);
         }
-        return std::get<int>(*this);
+        return std::get<int>(value_);
     }
 
     bool IsPureDouble() const {
-        return std::holds_alternative<double>(*this);
+        return std::holds_alternative<double>(value_);
     }
     bool IsDouble() const {
         return IsInt() || IsPureDouble();
@@ -45,11 +167,11 @@ public:
         if (!IsDouble()) {
             throw std::logic_error("Not a double"s);
         }
-        return IsPureDouble() ? std::get<double>(*this) : AsInt();
+        return IsPureDouble() ? std::get<double>(value_) : AsInt();
     }
 
     bool IsBool() const {
-        return std::holds_alternative<bool>(*this);
+        return std::holds_alternative<bool>(value_);
     }
     bool AsBool() const {
         using namespace std::literals;
@@ -57,15 +179,15 @@ public:
             throw std::logic_error("Not a bool"s);
         }
 
-        return std::get<bool>(*this);
+        return std::get<bool>(value_);
     }
 
     bool IsNull() const {
-        return std::holds_alternative<std::nullptr_t>(*this);
+        return std::holds_alternative<std::nullptr_t>(value_);
     }
 
     bool IsArray() const {
-        return std::holds_alternative<Array>(*this);
+        return std::holds_alternative<Box<Array>>(value_);
     }
     const Array& AsArray() const {
         using namespace std::literals;
@@ -73,23 +195,26 @@ public:
             throw std::logic_error("Not an array"s);
         }
 
-        return std::get<Array>(*this);
+        return *std::get<Box<Array>>(value_);
     }
 
     bool IsString() const {
-        return std::holds_alternative<std::string>(*this);
+        return std::holds_alternative<Box<std::pmr::string>>(value_) || std::holds_alternative<StringRef>(value_);
     }
-    const std::string& AsString() const {
+    std::string_view AsString() const {
         using namespace std::literals;
+        if (const auto* ref = std::get_if<StringRef>(&value_)) {
+            return *ref;
+        }
         if (!IsString()) {
             throw std::logic_error("Not a string"s);
         }
 
-        return std::get<std::string>(*this);
+        return *std::get<Box<std::pmr::string>>(value_);
     }
 
     bool IsDict() const {
-        return std::holds_alternative<Dict>(*this);
+        return std::holds_alternative<Box<Dict>>(value_);
     }
     const Dict& AsDict() const {
         using namespace std::literals;
@@ -97,15 +222,35 @@ public:
             throw std::logic_error("Not a dict"s);
         }
 
-        return std::get<Dict>(*this);
+        return *std::get<Box<Dict>>(value_);
     }
 
-    bool operator==(const Node& rhs) const {
-        return GetValue() == rhs.GetValue();
+    bool operator==(const Node& rhs) const;
+
+    // Вызывает visitor для значения узла: nullptr, Array, Dict, bool, int, double или std::string_view
+    template <typename Visitor>
+    decltype(auto) Visit(Visitor&& visitor) const {
+        return std::visit([&visitor](const auto& value) -> decltype(auto) {
+            return visitor(Unbox(value));
+        }, value_);
     }
 
-    const Value& GetValue() const {
-        return *this;
+private:
+    std::variant<std::nullptr_t, Box<Array>, Box<Dict>, bool, int, double, Box<std::pmr::string>, StringRef> value_;
+
+    template <typename T>
+    static const T& Unbox(const T& value) {
+        return value;
+    }
+    template <typename T>
+    static const T& Unbox(const Box<T>& value) {
+        return *value;
+    }
+    static std::string_view Unbox(const Box<std::pmr::string>& value) {
+        return *value;
+    }
+    static std::string_view Unbox(const StringRef& value) {
+        return value;
     }
 };
 
@@ -113,6 +258,104 @@ inline bool operator!=(const Node& lhs, const Node& rhs) {
     return !(lhs == rhs);
 }
 
+// Словарь хранит пары в векторе, упорядоченном по ключу, как их упорядочивал std::map.
+// Небольшие словари просматриваются подряд, большие - двоичным поиском
+class Dict {
+public:
+    using value_type = std::pair<std::pmr::string, Node>;
+    using allocator_type = std::pmr::polymorphic_allocator<value_type>;
+    using iterator = std::pmr::vector<value_type>::iterator;
+    using const_iterator = std::pmr::vector<value_type>::const_iterator;
+
+    Dict() = default;
+    explicit Dict(const allocator_type& allocator)
+        : entries_(allocator) {
+    }
+    Dict(std::initializer_list<std::pair<std::string_view, Node>> entries);
+
+    allocator_type get_allocator() const {
+        return entries_.get_allocator();
+    }
+
+    iterator begin() {
+        return entries_.begin();
+    }
+    iterator end() {
+        return entries_.end();
+    }
+    const_iterator begin() const {
+        return entries_.begin();
+    }
+    const_iterator end() const {
+        return entries_.end();
+    }
+    size_t size() const {
+        return entries_.size();
+    }
+    bool empty() const {
+        return entries_.empty();
+    }
+    void reserve(size_t size) {
+        entries_.reserve(size);
+    }
+
+    iterator find(std::string_view key);
+    const_iterator find(std::string_view key) const;
+    size_t count(std::string_view key) const {
+        return find(key) != end() ? 1 : 0;
+    }
+    const Node& at(std::string_view key) const;
+
+    // Как у std::map: вставляет пустой узел, если ключа ещё нет
+    Node& operator[](std::string_view key) {
+        return try_emplace(key).first->second;
+    }
+    std::pair<iterator, bool> try_emplace(std::string_view key, Node value = {}) {
+        return try_emplace(std::pmr::string{key, get_allocator()}, std::move(value));
+    }
+    std::pair<iterator, bool> try_emplace(std::pmr::string key, Node value = {});
+    std::pair<iterator, bool> emplace(std::string_view key, Node value) {
+        return try_emplace(key, std::move(value));
+    }
+
+    bool operator==(const Dict& rhs) const {
+        return entries_ == rhs.entries_;
+    }
+    bool operator!=(const Dict& rhs) const {
+        return !(*this == rhs);
+    }
+
+private:
+    std::pmr::vector<value_type> entries_;
+
+    // Первая пара с ключом не меньше key
+    size_t LowerBound(std::string_view key) const;
+};
+
+inline Node::Node(Dict value)
+    : value_(std::in_place_type<Box<Dict>>, std::move(value)) {
+}
+
+inline Node::Node(const Node& other)
+    : value_(other.value_) {
+    if (const auto* ref = std::get_if<StringRef>(&value_)) {
+        value_.emplace<Box<std::pmr::string>>(std::pmr::string{std::string_view{*ref}});
+    }
+}
+
+// Строка-ссылка и строка-значение равны, если совпадает их текст
+inline bool Node::operator==(const Node& rhs) const {
+    return Visit([&rhs](const auto& value) {
+        return rhs.Visit([&value](const auto& rhs_value) {
+            if constexpr (std::is_same_v<decltype(value), decltype(rhs_value)>) {
+                return value == rhs_value;
+            } else {
+                return false;
+            }
+        });
+    });
+}
+
 class Document {
 public:
     Document() = default;
@@ -120,12 +363,27 @@ public:
     explicit Document(Node root)
         : root_(std::move(root)) {
     }
+    // Все узлы root лежат в arena. Документ освобождает её целиком, не обходя узлы.
+    // text - текст, на который ссылаются строки документа, прочитанного на месте
+    Document(std::unique_ptr<std::pmr::monotonic_buffer_resource> arena, Node root,
+             std::unique_ptr<std::string> text = nullptr);
+
+    // Копия не зависит от арены исходного документа
+    Document(const Document& other)
+        : root_(other.GetRoot()) {
+    }
+    Document(Document&& other) noexcept;
+    Document& operator=(Document other) noexcept;
 
     const Node& GetRoot() const {
-        return root_;
+        return arena_root_ ? *arena_root_ : root_;
     }
 
 private:
+    std::unique_ptr<std::string> text_;
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> arena_;
+    // Корень из арены не разрушается: его память уходит вместе с ареной
+    Node* arena_root_ = nullptr;
     Node root_;
 };
 
@@ -137,8 +395,43 @@ inline bool operator!=(const Document& lhs, const Document& rhs) {
     return !(lhs == rhs);
 }
 
+// Текст документа целиком лежит в одном буфере и разбирается по указателю. Строки, массивы и словари
+// документа выделяются из его арены. Из потока забирается ровно одно значение,
+// поэтому документы можно читать из него подряд
+Document Load(std::string_view input);
 Document Load(std::istream& input);
+// Разбор на месте: документ забирает текст себе, раскодирует строки прямо в нём
+// и не копирует их, а строковые узлы ссылаются на текст. Load из потока читает так же
+Document LoadInSitu(std::string text);
 
 void Print(const Document& doc, std::ostream& output);
+// Печатает строку в кавычках, экранируя спецсимволы
+void PrintString(std::string_view value, std::ostream& out);
+// Печатают число так же, как operator<< потока с форматом по умолчанию
+void PrintNumber(int value, std::ostream& out);
+void PrintNumber(double value, std::ostream& out);
+
+// Читает словарь верхнего уровня из потока по частям: ключи по одному, значение ключа целиком
+// или, если это массив, поэлементно. В памяти одновременно находится только одно значение
+class DictReader {
+public:
+    // Читает открывающую скобку словаря
+    explicit DictReader(std::istream& input);
+
+    // Следующий ключ вместе с двоеточием после него или nullopt, если словарь закончился.
+    // Значение ключа нужно прочитать до следующего вызова
+    std::optional<std::string> NextKey();
+    Node ReadValue();
+
+    // Читает открывающую скобку массива, элементы которого затем возвращает NextItem
+    void StartArray();
+    // Следующий элемент массива или nullopt, если массив закончился
+    std::optional<Node> NextItem();
+
+private:
+    std::istream& input_;
+    bool is_first_key_ = true;
+    bool is_first_item_ = true;
+};
 
 }  // namespace json
\ No newline at end of file
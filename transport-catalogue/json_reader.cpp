@@ -1,6 +1,6 @@
 #include "json_reader.h"
 #include "json.h"
-#include "json_builder.h"
+#include "json_writer.h"
 #include "map_renderer.h"
 #include "transport_router.h"
 
@@ -9,6 +9,7 @@
 #include <vector>
 #include <sstream>
 #include <string>
+#include <limits>
 
 using namespace std::literals;
 /*
@@ -16,12 +17,15 @@ using namespace std::literals;
  * а также код обработки запросов к базе и формирование массива ответов в формате JSON
  */
 
-JsonReader::JsonReader(std::istream& input, RequestHandler& request_handler) 
-    : doc_(std::move(json::Load(input)))
-    , request_handler_(request_handler) {
+JsonReader::JsonReader(std::istream& input) 
+    : doc_(std::move(json::Load(input))) {
 }
 
-void JsonReader::ProcessBaseRequests() const {
+JsonReader::JsonReader(json::Document doc)
+    : doc_(std::move(doc)) {
+}
+
+void JsonReader::ProcessBaseRequests(BaseRequestHandler& request_handler) const {
     auto requests = doc_.GetRoot().AsDict().at("base_requests"s);
     
     std::vector<domain::BusBaseRequest> bus_requests;
@@ -36,8 +40,37 @@ void JsonReader::ProcessBaseRequests() const {
         }
     }
     
-    request_handler_.HandleStopBaseRequests(stop_requests);
-    request_handler_.HandleBusBaseRequests(bus_requests);
+    request_handler.HandleStopBaseRequests(stop_requests);
+    request_handler.HandleBusBaseRequests(bus_requests);
+}
+
+// Изменения применяются в порядке: новые остановки, расстояния, удаление автобусов,
+// затем добавление и изменение автобусов
+void JsonReader::ProcessUpdateRequests(BaseRequestHandler& request_handler) const {
+    const auto& requests = doc_.GetRoot().AsDict().at("update_requests"s).AsArray();
+    
+    std::vector<domain::StopBaseRequest> stop_requests;
+    std::vector<domain::RoadDistanceBaseRequest> road_distance_requests;
+    std::vector<std::string_view> bus_remove_requests;
+    std::vector<domain::BusBaseRequest> bus_requests;
+    
+    for (const auto& request: requests) {
+        const auto& request_type = request.AsDict().at("type"s).AsString();
+        if (request_type == "Stop"s) {
+            stop_requests.push_back(ExtractStopBaseRequest(request.AsDict()));
+        } else if (request_type == "RoadDistance"s) {
+            road_distance_requests.push_back(ExtractRoadDistanceRequest(request.AsDict()));
+        } else if (request_type == "RemoveBus"s) {
+            bus_remove_requests.push_back(request.AsDict().at("name"s).AsString());
+        } else if (request_type == "Bus"s) {
+            bus_requests.push_back(ExtractBusBaseRequest(request.AsDict()));
+        }
+    }
+    
+    request_handler.HandleStopBaseRequests(stop_requests);
+    request_handler.HandleRoadDistanceRequests(road_distance_requests);
+    request_handler.HandleBusRemoveRequests(bus_remove_requests);
+    request_handler.HandleBusBaseRequests(bus_requests);
 }
 
 domain::StopBaseRequest JsonReader::ExtractStopBaseRequest(const json::Dict& request) const {
@@ -45,7 +78,7 @@ domain::StopBaseRequest JsonReader::ExtractStopBaseRequest(const json::Dict& req
     auto lat = request.at("latitude"s).AsDouble();
     auto lng = request.at("longitude"s).AsDouble();
     
-    std::unordered_map<std::string, int> distances;
+    std::unordered_map<std::string_view, int> distances;
     for (const auto& [key, value]: request.at("road_distances"s).AsDict()) {
        distances[key] = value.AsInt(); 
     }
@@ -57,43 +90,99 @@ domain::BusBaseRequest JsonReader::ExtractBusBaseRequest(const json::Dict& reque
     auto name = request.at("name"s).AsString();
     auto is_roundtrip = request.at("is_roundtrip"s).AsBool();
     
-    std::vector<std::string> stops;
+    std::vector<std::string_view> stops;
     for (const auto& stop_name: request.at("stops"s).AsArray()) {
         stops.push_back(stop_name.AsString());
     }
     
     return {name, stops, is_roundtrip};
 }
+    
+domain::RoadDistanceBaseRequest JsonReader::ExtractRoadDistanceRequest(const json::Dict& request) const {
+    return {request.at("from"s).AsString(), request.at("to"s).AsString(), request.at("distance"s).AsInt()};
+}
 
 
-json::Document JsonReader::ProcessStatRequests(const RenderSettings& render_settings, const TransportRouter& router) const {
-    auto requests = doc_.GetRoot().AsDict().at("stat_requests"s).AsArray();
+void JsonReader::ProcessStatRequests(std::ostream& output, const RequestHandler& request_handler, const RenderSettings& render_settings,
+                                     const RoutingSettings& routing_settings, const TransportRouter* router) const {
+    const auto& requests = doc_.GetRoot().AsDict().at("stat_requests"s).AsArray();
     
-    json::Builder response_builder;
-    response_builder.StartArray();
+    json::Writer writer(output);
+    writer.StartArray();
     for (const auto& request: requests) {
-        json::Builder response_part_builder; 
-        response_part_builder.StartDict()
-            .Key("request_id"s).Value(request.AsDict().at("id"s).AsInt());
-        
-        auto request_type = request.AsDict().at("type").AsString();
-        if (request_type == "Bus"s) {
-            BuildResponseForBusRequest(request.AsDict(), response_part_builder);
-        } else if (request_type == "Stop"s) {
-            BuildResponseForStopRequest(request.AsDict(), response_part_builder);
-        } else if (request_type == "Map"s) {
-            BuildResponseForMapRequest(response_part_builder, render_settings);
-        } else if (request_type == "Route"s) {
-            BuildResponseForRouteRequest(request.AsDict(), response_part_builder, router);
+        ProcessStatRequest(request.AsDict(), writer, request_handler, render_settings, routing_settings, router);
+    }
+    writer.EndArray();
+}
+
+// Каждый ответ пишет свой словарь целиком: ключи идут по возрастанию, как их печатает json::Print
+void JsonReader::ProcessStatRequest(const json::Dict& request, json::Writer& writer, const RequestHandler& request_handler,
+                                    const RenderSettings& render_settings, const RoutingSettings& routing_settings,
+                                    const TransportRouter* router) const {
+    const int request_id = request.at("id"s).AsInt();
+    writer.StartDict();
+    
+    const auto& request_type = request.at("type").AsString();
+    if (request_type == "Bus"s) {
+        BuildResponseForBusRequest(request, request_id, writer, request_handler);
+    } else if (request_type == "Stop"s) {
+        BuildResponseForStopRequest(request, request_id, writer, request_handler);
+    } else if (request_type == "Map"s) {
+        BuildResponseForMapRequest(request_id, writer, render_settings, request_handler);
+    } else if (request_type == "Route"s) {
+        BuildResponseForRouteRequest(request, request_id, writer, *router);
+    } else if (request_type == "DirectBuses"s) {
+        BuildResponseForDirectBusesRequest(request, request_id, writer, request_handler, routing_settings);
+    } else if (request_type == "NearestStops"s) {
+        BuildResponseForNearestStopsRequest(request, request_id, writer, request_handler);
+    } else if (request_type == "StopsInBox"s) {
+        BuildResponseForStopsInBoxRequest(request, request_id, writer, request_handler);
+    } else if (request_type == "Suggest"s) {
+        BuildResponseForSuggestRequest(request, request_id, writer, request_handler);
+    } else {
+        writer.Key("request_id"s).Value(request_id);
+    }
+    
+    writer.EndDict();
+}
+
+bool JsonReader::HasStatRequests(std::string_view type) const {
+    const auto& root = doc_.GetRoot().AsDict();
+    if (!root.count("stat_requests"s)) {
+        return false;
+    }
+    for (const auto& request: root.at("stat_requests"s).AsArray()) {
+        if (request.AsDict().at("type"s).AsString() == type) {
+            return true;
         }
-        
-        response_builder.Value(response_part_builder.EndDict().Build().AsDict()).EndDict();     
     }
-    return json::Document(response_builder.EndArray().Build());
+    return false;
 }
 
 std::string JsonReader::GetSerializationFileName() const {
-    return doc_.GetRoot().AsDict().at("serialization_settings"s).AsDict().at("file"s).AsString();
+    return std::string{doc_.GetRoot().AsDict().at("serialization_settings"s).AsDict().at("file"s).AsString()};
+}
+
+// Формат задаётся необязательным полем format: "protobuf" (по умолчанию), "zlib" или "image"
+transport_catalogue::BaseFormat JsonReader::GetSerializationFormat() const {
+    const auto& settings = doc_.GetRoot().AsDict().at("serialization_settings"s).AsDict();
+    if (!settings.count("format"s)) {
+        return transport_catalogue::BaseFormat::PROTOBUF;
+    }
+    const auto& format = settings.at("format"s).AsString();
+    if (format == "image"s) {
+        return transport_catalogue::BaseFormat::IMAGE;
+    }
+    if (format == "zlib"s) {
+        return transport_catalogue::BaseFormat::COMPRESSED_PROTOBUF;
+    }
+    return transport_catalogue::BaseFormat::PROTOBUF;
+}
+
+// Граф маршрутизации пишется в базу, только если в serialization_settings задано "store_router_graph": true
+bool JsonReader::ShouldStoreRouterGraph() const {
+    const auto& settings = doc_.GetRoot().AsDict().at("serialization_settings"s).AsDict();
+    return settings.count("store_router_graph"s) && settings.at("store_router_graph"s).AsBool();
 }
 
 RenderSettings JsonReader::GetRenderSettings() const {
@@ -120,7 +209,7 @@ RenderSettings JsonReader::GetRenderSettings() const {
     
     settings.underlayer_color = TransformToColor(json_settings.at("underlayer_color"s));
     
-    for (const auto color: json_settings.at("color_palette"s).AsArray()) {
+    for (const auto& color: json_settings.at("color_palette"s).AsArray()) {
         settings.color_palette.push_back(TransformToColor(color));
     }
     
@@ -139,7 +228,7 @@ RoutingSettings JsonReader::GetRoutingSettings() const {
 
 svg::Color JsonReader::TransformToColor(const json::Node& node) {
     if (node.IsString()) {
-        return node.AsString();
+        return std::string{node.AsString()};
     }
     
     auto arr = node.AsArray();
@@ -151,74 +240,171 @@ svg::Color JsonReader::TransformToColor(const json::Node& node) {
     
 }
 
-void JsonReader::BuildResponseForBusRequest(const json::Dict& request, json::Builder& builder) const {
-    auto bus_stat = request_handler_.GetBusStat(request.at("name"s).AsString());
+void JsonReader::BuildResponseForBusRequest(const json::Dict& request, int request_id, json::Writer& writer,
+                                            const RequestHandler& request_handler) const {
+    auto bus_stat = request_handler.GetBusStat(request.at("name"s).AsString());
     if (bus_stat) {
-        builder
+        writer
             .Key("curvature"s).Value(bus_stat->curvature)
+            .Key("request_id"s).Value(request_id)
             .Key("route_length"s).Value(bus_stat->route_length)
             .Key("stop_count"s).Value(bus_stat->stop_count)
             .Key("unique_stop_count"s).Value(bus_stat->unique_stop_count);
     } else {
-        builder.Key("error_message"s).Value("not found"s);
+        WriteNotFound(request_id, writer);
     }
 }
 
-void JsonReader::BuildResponseForStopRequest(const json::Dict& request, json::Builder& builder) const {
-auto stop_stat = request_handler_.GetStopStat(request.at("name"s).AsString());
+void JsonReader::BuildResponseForStopRequest(const json::Dict& request, int request_id, json::Writer& writer,
+                                             const RequestHandler& request_handler) const {
+    auto stop_stat = request_handler.GetStopStat(request.at("name"s).AsString());
     if (stop_stat) {
-        builder.Key("buses"s).StartArray();
-        for (auto bus_name: stop_stat->buses) {
-            builder.Value(std::string{bus_name});
+        writer.Key("buses"s).StartArray();
+        for (auto bus_id: stop_stat->buses) {
+            writer.Value(request_handler.GetBusName(bus_id));
         }
-        builder.EndArray();
+        writer.EndArray();
+        writer.Key("request_id"s).Value(request_id);
     } else {
-        builder.Key("error_message"s).Value("not found"s);
+        WriteNotFound(request_id, writer);
     }         
 }
 
-void JsonReader::BuildResponseForMapRequest(json::Builder& builder, const RenderSettings& settings) const {
-    //auto settings = GetRenderSettings();
-    auto doc = request_handler_.RenderRoutes(settings);
+void JsonReader::BuildResponseForMapRequest(int request_id, json::Writer& writer, const RenderSettings& settings,
+                                            const RequestHandler& request_handler) const {
+    auto doc = request_handler.RenderRoutes(settings);
     std::ostringstream out;
     doc.Render(out);
-    builder.Key("map"s).Value(out.str()); 
+    writer
+        .Key("map"s).Value(out.str())
+        .Key("request_id"s).Value(request_id); 
 }
 
-void JsonReader::BuildResponseForRouteRequest(const json::Dict& request, json::Builder& builder, const TransportRouter& router) const {
-    auto from = request.at("from"s).AsString();
-    auto to = request.at("to"s).AsString();
+// Необязательные поля: count - число остановок (по умолчанию 1), radius - предельное расстояние в метрах.
+// На отрицательный count отвечает ошибкой
+void JsonReader::BuildResponseForNearestStopsRequest(const json::Dict& request, int request_id, json::Writer& writer,
+                                                     const RequestHandler& request_handler) const {
+    geo::Coordinates point{request.at("latitude"s).AsDouble(), request.at("longitude"s).AsDouble()};
+    const int count = request.count("count"s) ? request.at("count"s).AsInt() : 1;
+    if (count < 0) {
+        WriteError(request_id, "invalid count"sv, writer);
+        return;
+    }
+    double radius = request.count("radius"s) ? request.at("radius"s).AsDouble() : std::numeric_limits<double>::infinity();
+    
+    writer.Key("request_id"s).Value(request_id);
+    writer.Key("stops"s).StartArray();
+    for (const auto& stop: request_handler.FindNearestStops(point, count, radius)) {
+        writer.StartDict()
+            .Key("distance"s).Value(stop.distance)
+            .Key("name"s).Value(stop.name)
+            .EndDict();
+    }
+    writer.EndArray();
+}
+
+void JsonReader::BuildResponseForStopsInBoxRequest(const json::Dict& request, int request_id, json::Writer& writer,
+                                                   const RequestHandler& request_handler) const {
+    geo::Coordinates min{request.at("min_latitude"s).AsDouble(), request.at("min_longitude"s).AsDouble()};
+    geo::Coordinates max{request.at("max_latitude"s).AsDouble(), request.at("max_longitude"s).AsDouble()};
+    
+    writer.Key("request_id"s).Value(request_id);
+    writer.Key("stops"s).StartArray();
+    for (auto name: request_handler.FindStopsInBox(min, max)) {
+        writer.Value(name);
+    }
+    writer.EndArray();
+}
+
+// Необязательное поле count - число подсказок каждого вида (по умолчанию 10).
+// На отрицательный count отвечает ошибкой
+void JsonReader::BuildResponseForSuggestRequest(const json::Dict& request, int request_id, json::Writer& writer,
+                                                const RequestHandler& request_handler) const {
+    const int count = request.count("count"s) ? request.at("count"s).AsInt() : 10;
+    if (count < 0) {
+        WriteError(request_id, "invalid count"sv, writer);
+        return;
+    }
+    const auto suggestions = request_handler.Suggest(request.at("prefix"s).AsString(), count);
+    
+    writer.Key("buses"s).StartArray();
+    for (auto name: suggestions.buses) {
+        writer.Value(name);
+    }
+    writer.EndArray();
+    
+    writer.Key("request_id"s).Value(request_id);
+    
+    writer.Key("stops"s).StartArray();
+    for (auto name: suggestions.stops) {
+        writer.Value(name);
+    }
+    writer.EndArray();
+}
+
+// Время в пути считается по расстоянию и скорости из настроек маршрутизации, без ожидания на остановке
+void JsonReader::BuildResponseForDirectBusesRequest(const json::Dict& request, int request_id, json::Writer& writer,
+                                                    const RequestHandler& request_handler, const RoutingSettings& routing_settings) const {
+    const auto direct_buses = request_handler.FindDirectBuses(request.at("from"s).AsString(), request.at("to"s).AsString());
+    if (!direct_buses) {
+        WriteNotFound(request_id, writer);
+        return;
+    }
+    
+    const double velocity = routing_settings.bus_velocity * 1000. / 60;
+    writer.Key("buses"s).StartArray();
+    for (const auto& direct_bus: *direct_buses) {
+        writer.StartDict()
+            .Key("bus"s).Value(direct_bus.bus)
+            .Key("span_count"s).Value(direct_bus.span_count)
+            .Key("time"s).Value(direct_bus.distance / velocity)
+            .EndDict();
+    }
+    writer.EndArray();
+    writer.Key("request_id"s).Value(request_id);
+}
+
+void JsonReader::BuildResponseForRouteRequest(const json::Dict& request, int request_id, json::Writer& writer,
+                                              const TransportRouter& router) const {
+    std::string from{request.at("from"s).AsString()};
+    std::string to{request.at("to"s).AsString()};
     const auto route_info = router.BuildRoute(from, to);
     
     if (!route_info) {
-        builder.Key("error_message"s).Value("not found"s);
-    } else {
-        builder
-            .Key("total_time"s)
-            .Value(route_info->total_time)
-            .Key("items"s)
-            .StartArray();
-        for (const auto& item: route_info->items) {
-            builder
-                .StartDict()
-                .Key("type"s);
-                    
-            if (item.span_count == 0) {
-                builder
-                    .Value("Wait"s)
-                    .Key("stop_name"s) 
-                    .Value(item.from);
-            } else {
-                builder
-                    .Value("bus"s)
-                    .Key("bus"s)
-                    .Value(item.bus)
-                    .Key("span_count"s)
-                    .Value(item.span_count);
-            }
-                
-            builder.Key("time"s).Value(item.time).EndDict();
-        }  
-        builder.EndArray();
-    }
-}
\ No newline at end of file
+        WriteNotFound(request_id, writer);
+        return;
+    }
+    
+    writer.Key("items"s).StartArray();
+    for (const auto& item: route_info->items) {
+        writer.StartDict();
+        if (item.span_count == 0) {
+            writer
+                .Key("stop_name"s).Value(item.from)
+                .Key("time"s).Value(item.time)
+                .Key("type"s).Value("Wait"sv);
+        } else {
+            writer
+                .Key("bus"s).Value(item.bus)
+                .Key("span_count"s).Value(item.span_count)
+                .Key("time"s).Value(item.time)
+                .Key("type"s).Value("bus"sv);
+        }
+        writer.EndDict();
+    }  
+    writer.EndArray();
+    
+    writer
+        .Key("request_id"s).Value(request_id)
+        .Key("total_time"s).Value(route_info->total_time);
+}
+
+void JsonReader::WriteNotFound(int request_id, json::Writer& writer) {
+    WriteError(request_id, "not found"sv, writer);
+}
+
+void JsonReader::WriteError(int request_id, std::string_view message, json::Writer& writer) {
+    writer
+        .Key("error_message"s).Value(message)
+        .Key("request_id"s).Value(request_id);
+}
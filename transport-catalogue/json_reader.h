@@ -1,14 +1,16 @@
 #pragma once
 
 #include "json.h"
+#include "base_image.h"
 #include "request_handler.h"
 #include "svg.h"
 #include "map_renderer.h"
 #include "transport_router.h"
-#include "json_builder.h"
+#include "json_writer.h"
 
 #include <iostream>
 #include <string>
+#include <string_view>
 /*
  * Здесь можно разместить код наполнения транспортного справочника данными из JSON,
  * а также код обработки запросов к базе и формирование массива ответов в формате JSON
@@ -16,25 +18,45 @@
 
 class JsonReader {
 public:
-    JsonReader(std::istream& input, RequestHandler& request_handler);
+    explicit JsonReader(std::istream& input);
+    explicit JsonReader(json::Document doc);
     
-    void ProcessBaseRequests() const;
-    json::Document ProcessStatRequests(const RenderSettings& render_settings, const TransportRouter& transport_router) const;
+    void ProcessBaseRequests(BaseRequestHandler& request_handler) const;
+    void ProcessUpdateRequests(BaseRequestHandler& request_handler) const;
+    // Ответы пишутся в поток по мере обработки. Роутер нужен только для запросов Route и может быть nullptr, если их нет
+    void ProcessStatRequests(std::ostream& output, const RequestHandler& request_handler, const RenderSettings& render_settings,
+                             const RoutingSettings& routing_settings, const TransportRouter* transport_router) const;
+    // Ответ на один запрос к базе, для обработки запросов по мере их чтения
+    void ProcessStatRequest(const json::Dict& request, json::Writer& writer, const RequestHandler& request_handler,
+                            const RenderSettings& render_settings, const RoutingSettings& routing_settings,
+                            const TransportRouter* transport_router) const;
+    bool HasStatRequests(std::string_view type) const;
     std::string GetSerializationFileName() const;
+    transport_catalogue::BaseFormat GetSerializationFormat() const;
+    bool ShouldStoreRouterGraph() const;
     RenderSettings GetRenderSettings() const;
     RoutingSettings GetRoutingSettings() const;
     
 private:
     json::Document doc_;
-    RequestHandler& request_handler_;
     
     domain::StopBaseRequest ExtractStopBaseRequest(const json::Dict& request) const;
     domain::BusBaseRequest ExtractBusBaseRequest(const json::Dict& request) const;
+    domain::RoadDistanceBaseRequest ExtractRoadDistanceRequest(const json::Dict& request) const;
     
     static svg::Color TransformToColor(const json::Node& node);
     
-    void BuildResponseForStopRequest(const json::Dict& request, json::Builder& builder) const;
-    void BuildResponseForBusRequest(const json::Dict& request, json::Builder& builder) const;
-    void BuildResponseForMapRequest(json::Builder& builder, const RenderSettings& settings) const;
-    void BuildResponseForRouteRequest(const json::Dict& request, json::Builder& builder, const TransportRouter& router) const;
+    void BuildResponseForStopRequest(const json::Dict& request, int request_id, json::Writer& writer, const RequestHandler& request_handler) const;
+    void BuildResponseForBusRequest(const json::Dict& request, int request_id, json::Writer& writer, const RequestHandler& request_handler) const;
+    void BuildResponseForMapRequest(int request_id, json::Writer& writer, const RenderSettings& settings, const RequestHandler& request_handler) const;
+    void BuildResponseForNearestStopsRequest(const json::Dict& request, int request_id, json::Writer& writer,
+                                             const RequestHandler& request_handler) const;
+    void BuildResponseForStopsInBoxRequest(const json::Dict& request, int request_id, json::Writer& writer,
+                                           const RequestHandler& request_handler) const;
+    void BuildResponseForSuggestRequest(const json::Dict& request, int request_id, json::Writer& writer, const RequestHandler& request_handler) const;
+    void BuildResponseForDirectBusesRequest(const json::Dict& request, int request_id, json::Writer& writer, const RequestHandler& request_handler,
+                                            const RoutingSettings& routing_settings) const;
+    void BuildResponseForRouteRequest(const json::Dict& request, int request_id, json::Writer& writer, const TransportRouter& router) const;
+    static void WriteNotFound(int request_id, json::Writer& writer);
+    static void WriteError(int request_id, std::string_view message, json::Writer& writer);
 };
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include "json_writer.h"
+
+#include <cassert>
+#include <stdexcept>
+
+using namespace std::literals;
+
+namespace json {
+
+namespace {
+const int INDENT_STEP = 4;
+const size_t RESERVED_DEPTH = 16;
+}
+
+Writer::Writer(std::ostream& output)
+    : output_(output) {
+    levels_.reserve(RESERVED_DEPTH);
+}
+
+Writer& Writer::Key(std::string_view key) {
+    if (levels_.empty() || !levels_.back().is_dict || levels_.back().has_key) {
+        throw std::logic_error("Key() invokation outside the Dict"s);
+    }
+    auto& level = levels_.back();
+#ifndef NDEBUG
+    // Вывод совпадает с Print, только пока ключи идут по возрастанию
+    assert(level.is_first || level.last_key < key);
+    level.last_key = key;
+#endif
+    if (!level.is_first) {
+        output_ << ",\n"sv;
+    }
+    level.is_first = false;
+    level.has_key = true;
+    PrintIndent(levels_.size());
+    PrintString(key, output_);
+    output_ << ": "sv;
+    return *this;
+}
+
+Writer& Writer::Value(std::nullptr_t) {
+    BeforeValue();
+    output_ << "null"sv;
+    return *this;
+}
+
+Writer& Writer::Value(bool value) {
+    BeforeValue();
+    output_ << (value ? "true"sv : "false"sv);
+    return *this;
+}
+
+Writer& Writer::Value(int value) {
+    BeforeValue();
+    PrintNumber(value, output_);
+    return *this;
+}
+
+Writer& Writer::Value(double value) {
+    BeforeValue();
+    PrintNumber(value, output_);
+    return *this;
+}
+
+Writer& Writer::Value(std::string_view value) {
+    BeforeValue();
+    PrintString(value, output_);
+    return *this;
+}
+
+Writer& Writer::Value(const char* value) {
+    return Value(std::string_view{value});
+}
+
+Writer& Writer::StartDict() {
+    BeforeValue();
+    output_ << "{\n"sv;
+    levels_.emplace_back(true);
+    return *this;
+}
+
+Writer& Writer::StartArray() {
+    BeforeValue();
+    output_ << "[\n"sv;
+    levels_.emplace_back(false);
+    return *this;
+}
+
+Writer& Writer::EndDict() {
+    EndContainer(true);
+    return *this;
+}
+
+Writer& Writer::EndArray() {
+    EndContainer(false);
+    return *this;
+}
+
+// Элемент массива печатается с новой строки и отступом, значение ключа - сразу после него
+void Writer::BeforeValue() {
+    if (levels_.empty()) {
+        if (is_ready_) {
+            throw std::logic_error("The object is ready"s);
+        }
+        is_ready_ = true;
+        return;
+    }
+    auto& level = levels_.back();
+    if (level.is_dict) {
+        if (!level.has_key) {
+            throw std::logic_error("Can't insert value"s);
+        }
+        level.has_key = false;
+        return;
+    }
+    if (!level.is_first) {
+        output_ << ",\n"sv;
+    }
+    level.is_first = false;
+    PrintIndent(levels_.size());
+}
+
+void Writer::PrintIndent(size_t depth) {
+    for (size_t i = 0; i < depth * INDENT_STEP; ++i) {
+        output_.put(' ');
+    }
+}
+
+void Writer::EndContainer(bool is_dict) {
+    if (levels_.empty() || levels_.back().is_dict != is_dict || levels_.back().has_key) {
+        throw std::logic_error(is_dict ? "Before end the Dict you should start it"s : "Before end the Array you should start it"s);
+    }
+    levels_.pop_back();
+    output_.put('\n');
+    PrintIndent(levels_.size());
+    output_.put(is_dict ? '}' : ']');
+}
+
+}  // namespace json
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "json.h"
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace json {
+
+// Пишет JSON прямо в поток по мере вызовов, не строя дерево узлов. Вывод совпадает с Print
+// для такого же дерева. Print печатает ключи словаря по возрастанию, поэтому и здесь ключи
+// нужно передавать в порядке возрастания. Отладочная сборка проверяет это в Key
+class Writer {
+public:
+    explicit Writer(std::ostream& output);
+
+    Writer& Key(std::string_view key);
+    Writer& Value(std::nullptr_t);
+    Writer& Value(bool value);
+    Writer& Value(int value);
+    Writer& Value(double value);
+    Writer& Value(std::string_view value);
+    Writer& Value(const char* value);
+    Writer& StartDict();
+    Writer& StartArray();
+    Writer& EndDict();
+    Writer& EndArray();
+
+private:
+    struct Level {
+        explicit Level(bool is_dict)
+            : is_dict(is_dict) {
+        }
+
+        bool is_dict;
+        bool is_first = true;
+        bool has_key = false;
+#ifndef NDEBUG
+        std::string last_key;
+#endif
+    };
+
+    std::ostream& output_;
+    // Открытые словари и массивы. Память под них выделяется один раз на всё время работы
+    std::vector<Level> levels_;
+    bool is_ready_ = false;
+
+    void BeforeValue();
+    void PrintIndent(size_t depth);
+    void EndContainer(bool is_dict);
+};
+
+}  // namespace json
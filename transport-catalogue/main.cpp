@@ -1,18 +1,101 @@
 #include "json.h"
 #include "json_reader.h"
+#include "json_writer.h"
 #include "request_handler.h"
 #include "transport_catalogue.h"
 #include "transport_router.h"
 #include "serialization.h"
+#include "base_watcher.h"
 
+#include <chrono>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <optional>
+#include <string>
 #include <string_view>
 
 //using namespace std::literals;
 
 void PrintUsage(std::ostream& stream = std::cerr) {
-    stream << "Usage: transport_catalogue [make_base|process_requests]\n"sv;
+    stream << "Usage: transport_catalogue [make_base|update_base|process_requests|stream_requests|serve_requests]\n"sv;
+}
+
+// Отвечает на запросы по мере их чтения: каждый ответ печатается и отправляется сразу,
+// а в памяти держится только текущий запрос. Вывод совпадает с process_requests.
+// Если stat_requests идут во входе раньше serialization_settings, массив приходится прочитать целиком
+int StreamRequests(std::istream& input, std::ostream& output) {
+    json::DictReader reader(input);
+    std::optional<JsonReader> settings_reader;
+    std::shared_ptr<const LoadedBase> base;
+    std::optional<json::Node> pending_requests;
+    
+    auto load_base = [&] {
+        base = LoadBase(settings_reader->GetSerializationFileName(), 0);
+        if (!base) {
+            std::cerr << "Failed to load base file "sv << settings_reader->GetSerializationFileName() << '\n';
+        }
+        return base != nullptr;
+    };
+    auto process = [&](json::Writer& writer, const json::Node& request) {
+        const auto& request_dict = request.AsDict();
+        const auto* router = request_dict.at("type"s).AsString() == "Route"s ? &base->GetRouter() : nullptr;
+        RequestHandler request_handler(*base->snapshot);
+        settings_reader->ProcessStatRequest(request_dict, writer, request_handler, base->render_settings,
+                                            base->routing_settings, router);
+        output.flush();
+    };
+    
+    while (const auto key = reader.NextKey()) {
+        if (*key == "serialization_settings"sv) {
+            settings_reader.emplace(json::Document{json::Dict{{*key, reader.ReadValue()}}});
+        } else if (*key == "stat_requests"sv && settings_reader) {
+            if (!load_base()) {
+                return 1;
+            }
+            reader.StartArray();
+            json::Writer writer(output);
+            writer.StartArray();
+            while (const auto request = reader.NextItem()) {
+                process(writer, *request);
+            }
+            writer.EndArray();
+        } else if (*key == "stat_requests"sv) {
+            pending_requests = reader.ReadValue();
+        } else {
+            reader.ReadValue();
+        }
+    }
+    
+    if (pending_requests) {
+        if (!settings_reader || !load_base()) {
+            return 1;
+        }
+        json::Writer writer(output);
+        writer.StartArray();
+        for (const auto& request: pending_requests->AsArray()) {
+            process(writer, request);
+        }
+        writer.EndArray();
+    }
+    return 0;
+}
+
+// База пишется во временный файл и подменяется переименованием, чтобы serve_requests
+// никогда не увидел файл, записанный наполовину. Если записать не удалось, прежний файл остаётся на месте
+bool WriteBase(const std::string& file_name, const transport_catalogue::CatalogueSnapshot& snapshot, transport_catalogue::BaseFormat format,
+               const RenderSettings& render_settings, const RoutingSettings& routing_settings, bool store_router_graph) {
+    const auto temp_file_name = file_name + ".tmp"s;
+    std::ofstream out(temp_file_name, std::ios::binary);
+    const bool is_saved = SaveTransportCatalogue(out, snapshot, format, render_settings, routing_settings, store_router_graph);
+    out.close();
+    if (!is_saved || !out) {
+        std::cerr << "Failed to write base file "sv << file_name << '\n';
+        std::filesystem::remove(temp_file_name);
+        return false;
+    }
+    std::filesystem::rename(temp_file_name, file_name);
+    return true;
 }
 
 int main(int argc, char* argv[]) {
@@ -22,29 +105,93 @@ int main(int argc, char* argv[]) {
     }
 
     const std::string_view mode(argv[1]);
+    // Потоки используются без stdio, а без синхронизации std::cin читает вход большими блоками
+    std::ios::sync_with_stdio(false);
 
     if (mode == "make_base"sv) {
         transport_catalogue::TransportCatalogue transport_catalogue;
-        RequestHandler request_handler(transport_catalogue);
-        JsonReader json_reader(std::cin, request_handler);
-        json_reader.ProcessBaseRequests();
+        BaseRequestHandler request_handler(transport_catalogue);
+        JsonReader json_reader(std::cin);
+        json_reader.ProcessBaseRequests(request_handler);
         auto render_settings = json_reader.GetRenderSettings();
         auto routing_settings = json_reader.GetRoutingSettings();
         
-        std::ofstream out(json_reader.GetSerializationFileName(), std::ios::binary);
-        SerializeTransportCatalogue(out, transport_catalogue, render_settings, routing_settings);
-    } else if (mode == "process_requests"sv) {
+        auto snapshot = transport_catalogue.Freeze();
+        if (!WriteBase(json_reader.GetSerializationFileName(), *snapshot, json_reader.GetSerializationFormat(), render_settings, routing_settings,
+                       json_reader.ShouldStoreRouterGraph())) {
+            return 1;
+        }
+    } else if (mode == "update_base"sv) {
+        // Применяет к готовой базе изменения из update_requests без повторного построения из base_requests
         transport_catalogue::TransportCatalogue transport_catalogue;
-        RequestHandler request_handler(transport_catalogue);
-        JsonReader json_reader(std::cin, request_handler);
+        JsonReader json_reader(std::cin);
         RenderSettings render_settings;
         RoutingSettings routing_settings;
         
-        std::ifstream in(json_reader.GetSerializationFileName(), std::ios::binary);
-        DeserializeTransportCatalogue(in, transport_catalogue, render_settings, routing_settings);
-        TransportRouter transport_router(transport_catalogue, routing_settings);
-        auto json_doc = json_reader.ProcessStatRequests(render_settings, transport_router);
-        json::Print(json_doc, std::cout);
+        // Обновлённая база пишется в том же формате, что и исходная
+        const auto file_name = json_reader.GetSerializationFileName();
+        const auto format = DetectBaseFormat(file_name);
+        if (!LoadTransportCatalogue(file_name, transport_catalogue, render_settings, routing_settings)) {
+            std::cerr << "Failed to load base file "sv << file_name << '\n';
+            return 1;
+        }
+        
+        BaseRequestHandler request_handler(transport_catalogue);
+        json_reader.ProcessUpdateRequests(request_handler);
+        auto snapshot = transport_catalogue.Freeze();
+        if (!WriteBase(file_name, *snapshot, format, render_settings, routing_settings, json_reader.ShouldStoreRouterGraph())) {
+            return 1;
+        }
+    } else if (mode == "process_requests"sv) {
+        JsonReader json_reader(std::cin);
+        RenderSettings render_settings;
+        RoutingSettings routing_settings;
+        
+        // Читаются только те части базы, которые нужны запросам пакета, а роутер строится только для Route
+        const bool has_route_requests = json_reader.HasStatRequests("Route"sv);
+        BaseParts parts;
+        parts.render_settings = json_reader.HasStatRequests("Map"sv);
+        parts.routing_settings = has_route_requests || json_reader.HasStatRequests("DirectBuses"sv);
+        
+        std::optional<TransportRouter::GraphData> router_graph;
+        auto snapshot = LoadSnapshot(json_reader.GetSerializationFileName(), render_settings, routing_settings, parts,
+                                     has_route_requests ? &router_graph : nullptr);
+        if (!snapshot) {
+            std::cerr << "Failed to load base file "sv << json_reader.GetSerializationFileName() << '\n';
+            return 1;
+        }
+        RequestHandler request_handler(*snapshot);
+        // Граф берётся из базы, а если его там нет (образ или старая база), строится по снимку
+        std::optional<TransportRouter> transport_router;
+        if (router_graph) {
+            transport_router.emplace(*snapshot, std::move(*router_graph));
+        } else if (has_route_requests) {
+            transport_router.emplace(*snapshot, routing_settings);
+        }
+        json_reader.ProcessStatRequests(std::cout, request_handler, render_settings, routing_settings,
+                                        transport_router ? &*transport_router : nullptr);
+    } else if (mode == "stream_requests"sv) {
+        return StreamRequests(std::cin, std::cout);
+    } else if (mode == "serve_requests"sv) {
+        // Читает из входа пакеты запросов один за другим. Каждый пакет обрабатывается на версии базы,
+        // актуальной в момент его прихода, а новые версии файла базы подгружаются в фоне
+        std::optional<BaseWatcher> base_watcher;
+        while (std::cin >> std::ws && std::cin.peek() != std::char_traits<char>::eof()) {
+            JsonReader json_reader(std::cin);
+            if (!base_watcher) {
+                base_watcher.emplace(json_reader.GetSerializationFileName(), std::chrono::seconds(1));
+            }
+            
+            auto base = base_watcher->GetCurrent();
+            if (!base) {
+                std::cerr << "Failed to load base file "sv << json_reader.GetSerializationFileName() << '\n';
+                return 1;
+            }
+            RequestHandler request_handler(*base->snapshot);
+            const auto* router = json_reader.HasStatRequests("Route"sv) ? &base->GetRouter() : nullptr;
+            json_reader.ProcessStatRequests(std::cout, request_handler, base->render_settings, base->routing_settings, router);
+            std::cout << std::endl;
+        }
     } else {
         PrintUsage();
         return 1;
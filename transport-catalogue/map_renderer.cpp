@@ -4,7 +4,6 @@
 #include "domain.h"
 
 #include <utility>
-#include <tuple>
 
 using namespace std::literals;
 
@@ -32,25 +31,25 @@ svg::Document MapRenderer::Render(const domain::MapStat& map_stat) const {
     
     
 void MapRenderer::RenderRouteLines(svg::Document& doc, const domain::MapStat& map_stat) const {
-    for (auto  [i, it] = std::tuple{0, map_stat.buses.begin()}; it != map_stat.buses.end(); ++i, ++it) {
+    for (size_t i = 0; i != map_stat.buses.size(); ++i) {
         svg::Polyline polyline;
         polyline.SetFillColor(svg::NoneColor).SetStrokeWidth(settings_.line_width).SetStrokeLineCap(svg::StrokeLineCap::ROUND);
         polyline.SetStrokeLineJoin(svg::StrokeLineJoin::ROUND).SetStrokeColor(settings_.color_palette[i % settings_.color_palette.size()]);
         
-        for (auto stop: (*it)->route) {
-            polyline.AddPoint(projector_(stop->coordinates));
+        for (auto stop: map_stat.buses[i].GetFullRoute()) {
+            polyline.AddPoint(projector_(map_stat.stops[stop].coordinates));
         }
         doc.Add(std::move(polyline));
     }
 }
 
 void MapRenderer::RenderText(svg::Document& doc, const geo::Coordinates& coordinates, 
-                             const std::string& data, const svg::Color& fill_color,
+                             std::string_view data, const svg::Color& fill_color,
                              svg::Point offset, int font_size, std::string font_weight) const {
     svg::Text underlayer;
     underlayer.SetPosition(projector_(coordinates))
               .SetOffset(offset)
-              .SetFontSize(font_size).SetFontFamily("Verdana"s).SetData(data);
+              .SetFontSize(font_size).SetFontFamily("Verdana"s).SetData(std::string{data});
     
     if (!font_weight.empty()) {
         underlayer.SetFontWeight(font_weight);
@@ -69,15 +68,15 @@ void MapRenderer::RenderText(svg::Document& doc, const geo::Coordinates& coordin
 }
 
 void MapRenderer::RenderRouteNames(svg::Document& doc, const domain::MapStat& map_stat) const {
-    for (auto  [i, it] = std::tuple{0, map_stat.buses.begin()}; it != map_stat.buses.end(); ++i, ++it) {
+    for (size_t i = 0; i != map_stat.buses.size(); ++i) {
+        const auto& bus = map_stat.buses[i];
         auto fill_color = settings_.color_palette[i % settings_.color_palette.size()];
-        auto data = (*it)->name;
         auto offset = svg::Point{settings_.bus_label_offset[0], settings_.bus_label_offset[1]};
         auto font_size = settings_.bus_label_font_size;
         auto font_weight = "bold"s;
-        RenderText(doc, (*it)->route[0]->coordinates, data, fill_color, offset, font_size, font_weight);
-        if (!(*it)->is_roundtrip && (*it)->route[((*it)->route.size() - 1) / 2] != (*it)->route[0]) {
-            RenderText(doc, (*it)->route[((*it)->route.size() - 1) / 2]->coordinates, data, fill_color, offset, font_size, font_weight);
+        RenderText(doc, map_stat.stops[bus.route[0]].coordinates, bus.name, fill_color, offset, font_size, font_weight);
+        if (!bus.is_roundtrip && bus.route.back() != bus.route[0]) {
+            RenderText(doc, map_stat.stops[bus.route.back()].coordinates, bus.name, fill_color, offset, font_size, font_weight);
         }
     }
 }
@@ -85,7 +84,7 @@ void MapRenderer::RenderRouteNames(svg::Document& doc, const domain::MapStat& ma
 void MapRenderer::RenderStopCircles(svg::Document& doc, const domain::MapStat& map_stat) const {
     for (const auto& stop: map_stat.stops) {
         svg::Circle circle;
-        circle.SetCenter(projector_(stop->coordinates)).SetRadius(settings_.stop_radius)
+        circle.SetCenter(projector_(stop.coordinates)).SetRadius(settings_.stop_radius)
               .SetFillColor("white"s);
         doc.Add(std::move(circle));                 
     }
@@ -94,10 +93,9 @@ void MapRenderer::RenderStopCircles(svg::Document& doc, const domain::MapStat& m
 void MapRenderer::RenderStopNames(svg::Document& doc, const domain::MapStat& map_stat) const {
     for ( const auto& stop: map_stat.stops) {
         svg::Color fill_color = "black"s;
-        auto data = stop->name;
         auto offset = svg::Point{settings_.stop_label_offset[0], settings_.stop_label_offset[1]};
         auto font_size = settings_.stop_label_font_size;
         auto font_weight = ""s;
-        RenderText(doc, stop->coordinates, data, fill_color, offset, font_size, font_weight);
+        RenderText(doc, stop.coordinates, stop.name, fill_color, offset, font_size, font_weight);
     }
 }
\ No newline at end of file
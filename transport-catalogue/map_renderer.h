@@ -7,9 +7,10 @@
 #include <algorithm>
 #include <cstdlib>
 #include <iostream>
+#include <iterator>
 #include <optional>
 #include <vector>
-#include <set>
+#include <string_view>
 #include <utility>
 
 inline const double EPSILON = 1e-6;
@@ -54,17 +55,17 @@ SphereProjector::SphereProjector(PointInputIt points_begin, PointInputIt points_
         return;
     }
 
-    const auto [left_it, right_it] = std::minmax_element(
-        points_begin, points_end,
-        [](auto lhs, auto rhs) { return lhs.lng < rhs.lng; });
-    min_lon_ = left_it->lng;
-    const double max_lon = right_it->lng;
-
-    const auto [bottom_it, top_it] = std::minmax_element(
-        points_begin, points_end,
-        [](auto lhs, auto rhs) { return lhs.lat < rhs.lat; });
-    const double min_lat = bottom_it->lat;
-    max_lat_ = top_it->lat;
+    // Границы по обеим осям находятся за один проход по плотному массиву координат
+    min_lon_ = points_begin->lng;
+    double max_lon = min_lon_;
+    double min_lat = points_begin->lat;
+    max_lat_ = min_lat;
+    for (auto it = std::next(points_begin); it != points_end; ++it) {
+        min_lon_ = std::min<double>(min_lon_, it->lng);
+        max_lon = std::max<double>(max_lon, it->lng);
+        min_lat = std::min<double>(min_lat, it->lat);
+        max_lat_ = std::max<double>(max_lat_, it->lat);
+    }
 
     std::optional<double> width_zoom;
     if (!IsZero(max_lon - min_lon_)) {
@@ -99,7 +100,7 @@ private:
     
     void RenderRouteLines(svg::Document& doc, const domain::MapStat& map_stat) const;
     void RenderText(svg::Document& doc, const geo::Coordinates& coordinates, 
-                    const std::string& data, const svg::Color& fill_color,
+                    std::string_view data, const svg::Color& fill_color,
                     svg::Point offset, int font_size, std::string font_weight) const;
     void RenderRouteNames(svg::Document& doc, const domain::MapStat& map_stat) const;
     void RenderStopCircles(svg::Document& doc, const domain::MapStat& map_stat) const;
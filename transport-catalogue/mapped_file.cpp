@@ -0,0 +1,69 @@
+#include "mapped_file.h"
+
+#include <cstdint>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TRANSPORT_CATALOGUE_HAS_MMAP
+#else
+#include <fstream>
+#endif
+
+std::shared_ptr<const MappedFile> MappedFile::Open(const std::string& file_name) {
+    std::shared_ptr<MappedFile> file(new MappedFile());
+    
+#ifdef TRANSPORT_CATALOGUE_HAS_MMAP
+    const int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+        close(fd);
+        return nullptr;
+    }
+    
+    // Отображение остаётся действительным и после закрытия дескриптора
+    void* data = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+    file->data_ = static_cast<const char*>(data);
+    file->size_ = file_stat.st_size;
+#else
+    std::ifstream in(file_name, std::ios::binary | std::ios::ate);
+    const auto size = static_cast<size_t>(in.tellg());
+    if (!in || size == 0) {
+        return nullptr;
+    }
+    file->buffer_.resize((size + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t));
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char*>(file->buffer_.data()), size)) {
+        return nullptr;
+    }
+    file->data_ = reinterpret_cast<const char*>(file->buffer_.data());
+    file->size_ = size;
+#endif
+    
+    return file;
+}
+
+MappedFile::~MappedFile() {
+#ifdef TRANSPORT_CATALOGUE_HAS_MMAP
+    if (data_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+}
+
+const char* MappedFile::GetData() const {
+    return data_;
+}
+
+size_t MappedFile::GetSize() const {
+    return size_;
+}
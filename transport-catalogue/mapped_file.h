@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Файл, отображённый в память только для чтения. Там, где отображение недоступно,
+// файл целиком читается в память, и интерфейс остаётся тем же
+class MappedFile {
+public:
+    // Возвращает nullptr, если файл не удалось открыть или он пуст
+    static std::shared_ptr<const MappedFile> Open(const std::string& file_name);
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+    
+    const char* GetData() const;
+    size_t GetSize() const;
+    
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    // Содержимое файла, если он прочитан, а не отображён. Элементы по 8 байт дают выравнивание
+    std::vector<std::uint64_t> buffer_;
+    
+    MappedFile() = default;
+};
@@ -0,0 +1,49 @@
+#include "name_prefix_index.h"
+
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace transport_catalogue {
+    
+NamePrefixIndex::NamePrefixIndex(const std::vector<std::string_view>& names)
+    : is_built_(true) {
+    std::vector<std::uint32_t> order(names.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&names](auto lhs, auto rhs) {
+        return names[lhs] < names[rhs];
+    });
+    order_ = std::move(order);
+}
+    
+NamePrefixIndex::NamePrefixIndex(storage::Column<std::uint32_t> order)
+    : order_(std::move(order))
+    , is_built_(true) {
+}
+    
+bool NamePrefixIndex::IsBuilt() const {
+    return is_built_;
+}
+    
+size_t NamePrefixIndex::GetSize() const {
+    return order_.size();
+}
+    
+bool NamePrefixIndex::IsValid(size_t count) const {
+    if (order_.size() != count || !storage::AreIdsBelow(order_, count)) {
+        return false;
+    }
+    std::vector<bool> is_seen(count, false);
+    for (auto id: order_) {
+        if (is_seen[id]) {
+            return false;
+        }
+        is_seen[id] = true;
+    }
+    return true;
+}
+    
+NamePrefixIndex::IdRange NamePrefixIndex::GetOrder() const {
+    return {order_.data(), order_.data() + order_.size()};
+}
+}
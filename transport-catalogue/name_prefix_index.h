@@ -0,0 +1,54 @@
+#pragma once
+
+#include "column.h"
+#include "ranges.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace transport_catalogue {
+    
+// Отсортированный по имени массив номеров. Имена с общим префиксом образуют в нём
+// непрерывный отрезок, который находится двумя двоичными поисками. Сами имена
+// индекс не хранит: их выдаёт get_name по номеру
+class NamePrefixIndex {
+public:
+    using IdRange = ranges::Range<const std::uint32_t*>;
+    
+    NamePrefixIndex() = default;
+    explicit NamePrefixIndex(const std::vector<std::string_view>& names);
+    explicit NamePrefixIndex(storage::Column<std::uint32_t> order);
+    
+    bool IsBuilt() const;
+    size_t GetSize() const;
+    // Является ли порядок перестановкой номеров от 0 до count - 1. Нужна для индекса,
+    // прочитанного из файла: номера из него сразу передаются в get_name
+    bool IsValid(size_t count) const;
+    // Все номера в порядке имён
+    IdRange GetOrder() const;
+    
+    // Номера имён, начинающихся с prefix, в порядке имён
+    template <typename NameGetter>
+    IdRange FindByPrefix(std::string_view prefix, NameGetter get_name) const;
+    
+private:
+    storage::Column<std::uint32_t> order_;
+    bool is_built_ = false;
+};
+    
+template <typename NameGetter>
+NamePrefixIndex::IdRange NamePrefixIndex::FindByPrefix(std::string_view prefix, NameGetter get_name) const {
+    const std::uint32_t* begin = order_.data();
+    const std::uint32_t* end = begin + order_.size();
+    
+    const auto* first = std::lower_bound(begin, end, prefix, [&get_name](std::uint32_t id, std::string_view value) {
+        return std::string_view(get_name(id)) < value;
+    });
+    const auto* last = std::partition_point(first, end, [&get_name, prefix](std::uint32_t id) {
+        return std::string_view(get_name(id)).substr(0, prefix.size()) == prefix;
+    });
+    return {first, last};
+}
+}
@@ -0,0 +1,142 @@
+#include "perfect_hash.h"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+namespace perfect_hash {
+    
+namespace {
+const std::uint32_t MAX_DISPLACEMENT = 1u << 20;
+const size_t KEYS_PER_BUCKET = 4;
+
+std::uint64_t Mix(std::uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+// Хеш не зависит от реализации std::hash, так как индекс сохраняется в файл базы
+std::uint64_t Hash(std::string_view name, std::uint64_t seed) {
+    std::uint64_t hash = 14695981039346656037ULL ^ Mix(seed);
+    for (unsigned char c: name) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return Mix(hash);
+}
+}
+    
+NameIndex::NameIndex(const std::vector<std::string_view>& names) {
+    // Неудача возможна только при совпадении 64-битных хешей, тогда пробуем другое зерно
+    while (!TryBuild(names)) {
+        ++seed_;
+    }
+}
+    
+NameIndex::NameIndex(std::uint64_t seed, storage::Column<std::uint32_t> displacements, storage::Column<std::uint32_t> slots)
+    : seed_(seed)
+    , displacements_(std::move(displacements))
+    , slots_(std::move(slots)) {
+}
+    
+bool NameIndex::IsBuilt() const {
+    return !displacements_.empty();
+}
+    
+size_t NameIndex::GetSize() const {
+    return slots_.size();
+}
+    
+bool NameIndex::IsValid(size_t count) const {
+    return !displacements_.empty() && slots_.size() == count && storage::AreIdsBelow(slots_, count);
+}
+    
+std::optional<size_t> NameIndex::Find(std::string_view name) const {
+    if (slots_.empty()) {
+        return std::nullopt;
+    }
+    const auto hash = Hash(name, seed_);
+    return slots_[GetSlot(hash, displacements_[GetBucket(hash, displacements_.size())], slots_.size())];
+}
+    
+std::uint64_t NameIndex::GetSeed() const {
+    return seed_;
+}
+    
+const storage::Column<std::uint32_t>& NameIndex::GetDisplacements() const {
+    return displacements_;
+}
+    
+const storage::Column<std::uint32_t>& NameIndex::GetSlots() const {
+    return slots_;
+}
+    
+bool NameIndex::TryBuild(const std::vector<std::string_view>& names) {
+    std::vector<std::uint32_t> displacements(std::max<size_t>(1, (names.size() + KEYS_PER_BUCKET - 1) / KEYS_PER_BUCKET), 0);
+    std::vector<std::uint32_t> slots(names.size(), 0);
+    
+    std::vector<std::uint64_t> hashes;
+    hashes.reserve(names.size());
+    std::vector<std::vector<std::uint32_t>> buckets(displacements.size());
+    for (const auto name: names) {
+        hashes.push_back(Hash(name, seed_));
+        buckets[GetBucket(hashes.back(), displacements.size())].push_back(hashes.size() - 1);
+    }
+    
+    // Большие корзины размещаются первыми, пока свободных слотов много
+    std::vector<size_t> order(buckets.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&buckets](size_t lhs, size_t rhs) {
+        return buckets[lhs].size() > buckets[rhs].size();
+    });
+    
+    std::vector<bool> occupied(names.size(), false);
+    std::vector<size_t> bucket_slots;
+    for (auto bucket_id: order) {
+        const auto& bucket = buckets[bucket_id];
+        if (bucket.empty()) {
+            break;
+        }
+        
+        std::uint32_t displacement = 0;
+        for (; displacement != MAX_DISPLACEMENT; ++displacement) {
+            bucket_slots.clear();
+            for (auto name_id: bucket) {
+                auto slot = GetSlot(hashes[name_id], displacement, slots.size());
+                if (occupied[slot] || std::find(bucket_slots.begin(), bucket_slots.end(), slot) != bucket_slots.end()) {
+                    break;
+                }
+                bucket_slots.push_back(slot);
+            }
+            if (bucket_slots.size() == bucket.size()) {
+                break;
+            }
+        }
+        if (displacement == MAX_DISPLACEMENT) {
+            return false;
+        }
+        
+        displacements[bucket_id] = displacement;
+        for (size_t i = 0; i != bucket.size(); ++i) {
+            occupied[bucket_slots[i]] = true;
+            slots[bucket_slots[i]] = bucket[i];
+        }
+    }
+    
+    displacements_ = std::move(displacements);
+    slots_ = std::move(slots);
+    return true;
+}
+    
+size_t NameIndex::GetBucket(std::uint64_t hash, size_t bucket_count) {
+    return (hash >> 32) % bucket_count;
+}
+    
+size_t NameIndex::GetSlot(std::uint64_t hash, std::uint32_t displacement, size_t slot_count) {
+    return Mix(hash + displacement * 0x9E3779B97F4A7C15ULL) % slot_count;
+}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "column.h"
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace perfect_hash {
+    
+// Минимальная совершенная хеш-функция (схема CHD) над фиксированным набором имён.
+// Каждому имени соответствует свой слот, поэтому поиск стоит одного хеширования строки
+// и одного сравнения: Find возвращает номер единственного кандидата, а проверить
+// совпадение имени должен вызывающий код
+class NameIndex {
+public:
+    NameIndex() = default;
+    explicit NameIndex(const std::vector<std::string_view>& names);
+    NameIndex(std::uint64_t seed, storage::Column<std::uint32_t> displacements, storage::Column<std::uint32_t> slots);
+    
+    bool IsBuilt() const;
+    // Число имён, по которым построен индекс. Их номера - от 0 до GetSize() - 1
+    size_t GetSize() const;
+    // Подходит ли индекс к набору из count имён. Нужна для индекса, прочитанного из файла:
+    // Find делит на число корзин и выдаёт номер из слота без проверок
+    bool IsValid(size_t count) const;
+    std::optional<size_t> Find(std::string_view name) const;
+    
+    std::uint64_t GetSeed() const;
+    const storage::Column<std::uint32_t>& GetDisplacements() const;
+    const storage::Column<std::uint32_t>& GetSlots() const;
+    
+private:
+    std::uint64_t seed_ = 0;
+    // Смещение для каждой корзины и номер имени для каждого слота
+    storage::Column<std::uint32_t> displacements_;
+    storage::Column<std::uint32_t> slots_;
+    
+    bool TryBuild(const std::vector<std::string_view>& names);
+    static size_t GetBucket(std::uint64_t hash, size_t bucket_count);
+    static size_t GetSlot(std::uint64_t hash, std::uint32_t displacement, size_t slot_count);
+};
+}
@@ -1,5 +1,6 @@
 #include "request_handler.h"
 #include "transport_catalogue.h"
+#include "catalogue_snapshot.h"
 #include "transport_router.h"
 
 #include <string>
@@ -12,53 +13,98 @@
  * можете оставить его пустым.
  */
 namespace detail {
-std::size_t StringPairHasher::operator()(const std::pair<std::string, std::string>& string_pair) const {
-    return std::hash<std::string>{}(string_pair.first) + 37 * std::hash<std::string>{}(string_pair.second);
+std::size_t StringPairHasher::operator()(const std::pair<std::string_view, std::string_view>& string_pair) const {
+    return std::hash<std::string_view>{}(string_pair.first) + 37 * std::hash<std::string_view>{}(string_pair.second);
 }
 }
 
-RequestHandler::RequestHandler(transport_catalogue::TransportCatalogue& db)
+BaseRequestHandler::BaseRequestHandler(transport_catalogue::TransportCatalogue& db)
     :db_(db) {}
 
-const std::optional<domain::BusStat> RequestHandler::GetBusStat(std::string_view bus_name) const {
-    return db_.GetBusStat(bus_name);
-}
-    
-const std::optional<domain::StopStat> RequestHandler::GetStopStat(std::string_view stop_name) const {
-    return db_.GetStopStat(stop_name);
-}
-
-void RequestHandler::HandleStopBaseRequests(const std::vector<domain::StopBaseRequest>& requests) {
-    using RoadDistanceMap =  std::unordered_map<const std::pair<std::string, std::string>, int, detail::StringPairHasher>;
+void BaseRequestHandler::HandleStopBaseRequests(const std::vector<domain::StopBaseRequest>& requests) {
+    using RoadDistanceMap =  std::unordered_map<const std::pair<std::string_view, std::string_view>, int, detail::StringPairHasher>;
     RoadDistanceMap road_distances;
     
     for (const auto& request: requests) {
-        db_.AddStop(request.name, request.lat, request.lng);
+        if (!db_.FindStop(request.name)) {
+            db_.AddStop(request.name, request.lat, request.lng);
+        }
         
         for (const auto& [stop_name, distance]: request.distances) {
             road_distances[std::make_pair(request.name, stop_name)] = distance;
         }
     }
     
+    // Расстояния до неизвестных остановок пропускаются, как и в HandleRoadDistanceRequests
     for (const auto& [stop_pair, distance]: road_distances) {
         auto stop1 = db_.FindStop(stop_pair.first);
         auto stop2 = db_.FindStop(stop_pair.second);
-        db_.SetDistanceBetweenStops(stop1, stop2, distance);
-        } 
+        if (stop1 && stop2) {
+            db_.SetDistanceBetweenStops(stop1, stop2, distance);
+        }
+    }
 }
 
-void RequestHandler::HandleBusBaseRequests(std::vector<domain::BusBaseRequest>& requests) {
-    for (auto& request: requests) {
-        if (!request.is_roundtrip) {
-            request.stops.reserve(request.stops.size() * 2);
-            for (auto it = request.stops.rbegin() + 1; it != request.stops.rend(); ++it) {
-                request.stops.push_back(*it);
-            }
+// Автобус с неизвестной остановкой пропускается: AddBus и ModifyBus тогда не меняют справочник
+void BaseRequestHandler::HandleBusBaseRequests(const std::vector<domain::BusBaseRequest>& requests) {
+    for (const auto& request: requests) {
+        if (auto bus = db_.FindBus(request.name)) {
+            db_.ModifyBus(bus, request.stops, request.is_roundtrip);
+        } else {
+            db_.AddBus(request.name, request.stops, request.is_roundtrip);
+        }
+    }
+}
+    
+void BaseRequestHandler::HandleRoadDistanceRequests(const std::vector<domain::RoadDistanceBaseRequest>& requests) {
+    for (const auto& request: requests) {
+        auto from = db_.FindStop(request.from);
+        auto to = db_.FindStop(request.to);
+        if (from && to) {
+            db_.SetDistanceBetweenStops(from, to, request.distance);
+        }
+    }
+}
+    
+void BaseRequestHandler::HandleBusRemoveRequests(const std::vector<std::string_view>& bus_names) {
+    for (const auto& name: bus_names) {
+        if (auto bus = db_.FindBus(name)) {
+            db_.RemoveBus(bus);
         }
-        db_.AddBus(request.name, request.stops, request.is_roundtrip);
     }
 }
 
+RequestHandler::RequestHandler(const transport_catalogue::CatalogueSnapshot& db)
+    :db_(db) {}
+
+const std::optional<domain::BusStat> RequestHandler::GetBusStat(std::string_view bus_name) const {
+    return db_.GetBusStat(bus_name);
+}
+    
+const std::optional<domain::StopStat> RequestHandler::GetStopStat(std::string_view stop_name) const {
+    return db_.GetStopStat(stop_name);
+}
+    
+std::string_view RequestHandler::GetBusName(size_t bus_id) const {
+    return db_.GetColumns().GetBusName(bus_id);
+}
+
+std::optional<std::vector<domain::DirectBus>> RequestHandler::FindDirectBuses(std::string_view from, std::string_view to) const {
+    return db_.FindDirectBuses(from, to);
+}
+    
+std::vector<domain::NearbyStop> RequestHandler::FindNearestStops(geo::Coordinates point, size_t count, double max_distance) const {
+    return db_.FindNearestStops(point, count, max_distance);
+}
+    
+std::vector<std::string_view> RequestHandler::FindStopsInBox(geo::Coordinates min, geo::Coordinates max) const {
+    return db_.FindStopsInBox(min, max);
+}
+
+domain::Suggestions RequestHandler::Suggest(std::string_view prefix, size_t count) const {
+    return db_.Suggest(prefix, count);
+}
+
 svg::Document RequestHandler::RenderRoutes(const RenderSettings& settings) const {
     auto coordinates = db_.GetStopsCoordinates();
     MapRenderer renderer(coordinates.begin(), coordinates.end(), settings);
@@ -68,4 +114,4 @@ svg::Document RequestHandler::RenderRoutes(const RenderSettings& settings) const
 
 TransportRouter RequestHandler::GetRouter(const RoutingSettings& settings) const {
     return TransportRouter(db_, settings);
-}
\ No newline at end of file
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "transport_catalogue.h"
+#include "catalogue_snapshot.h"
 #include "domain.h"
 #include "json.h"
 #include "svg.h"
@@ -15,23 +16,42 @@ using namespace std::literals;
 
 namespace detail {
 struct StringPairHasher {
-    std::size_t operator()(const std::pair<std::string, std::string>& string_pair) const;
+    std::size_t operator()(const std::pair<std::string_view, std::string_view>& string_pair) const;
 };
 }
 
+// Наполняет справочник базовыми запросами и точечно обновляет уже построенный.
+// Запрос на уже существующий автобус заменяет его маршрут, на существующую остановку - обновляет расстояния
+class BaseRequestHandler {
+public:
+    BaseRequestHandler(transport_catalogue::TransportCatalogue& db);
+    
+    void HandleBusBaseRequests(const std::vector<domain::BusBaseRequest>& requests);
+    void HandleStopBaseRequests(const std::vector<domain::StopBaseRequest>& requests);
+    void HandleRoadDistanceRequests(const std::vector<domain::RoadDistanceBaseRequest>& requests);
+    void HandleBusRemoveRequests(const std::vector<std::string_view>& bus_names);
+    
+private:
+    transport_catalogue::TransportCatalogue& db_;
+};
+
+// Обслуживает запросы к замороженному справочнику и может использоваться из нескольких потоков
 class RequestHandler {
 public:
-    RequestHandler(transport_catalogue::TransportCatalogue& db);
+    RequestHandler(const transport_catalogue::CatalogueSnapshot& db);
     
     const std::optional<domain::BusStat> GetBusStat(std::string_view bus_name) const;
     
     const std::optional<domain::StopStat> GetStopStat(std::string_view stop_name) const;
+    std::string_view GetBusName(size_t bus_id) const;
+    std::optional<std::vector<domain::DirectBus>> FindDirectBuses(std::string_view from, std::string_view to) const;
+    std::vector<domain::NearbyStop> FindNearestStops(geo::Coordinates point, size_t count, double max_distance) const;
+    std::vector<std::string_view> FindStopsInBox(geo::Coordinates min, geo::Coordinates max) const;
+    domain::Suggestions Suggest(std::string_view prefix, size_t count) const;
     
-    void HandleBusBaseRequests(std::vector<domain::BusBaseRequest>& requests);
-    void HandleStopBaseRequests(const std::vector<domain::StopBaseRequest>& requests);
     svg::Document RenderRoutes(const RenderSettings& settings) const;
     TransportRouter GetRouter(const RoutingSettings& settings) const;
     
 private:
-    transport_catalogue::TransportCatalogue& db_;
-};
\ No newline at end of file
+    const transport_catalogue::CatalogueSnapshot& db_;
+};
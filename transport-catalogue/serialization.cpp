@@ -1,4 +1,5 @@
 #include "transport_catalogue.h"
+#include "catalogue_snapshot.h"
 #include "map_renderer.h"
 #include "serialization.h"
 #include "transport_router.h"
@@ -10,11 +11,20 @@
 #include <map_renderer.pb.h>
 #include <transport_router.pb.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <iostream>
+#include <fstream>
 #include <vector>
 #include <string>
+#include <thread>
 #include <variant>
 
+#ifdef TRANSPORT_CATALOGUE_HAS_ZLIB
+#include <zlib.h>
+#endif
+
 
 svg_serialize::Color TransformToSerializeColor(const svg::Color& color) {
     svg_serialize::Color color_serialize;
@@ -73,53 +83,248 @@ render_settings_serialize::RenderSettings SerializeRenderSettings(const RenderSe
     return render_settings;
 }
 
-void SerializeTransportCatalogue(std::ostream& out, const transport_catalogue::TransportCatalogue& db,
-                                  const RenderSettings& render_settings, const RoutingSettings& routing_settings) {
-    transport_catalogue_serialize::TransportCatalogue catalogue_serialize;
-    
-    auto stops = db.GetStops();
-    for(const auto& stop: stops) {
-        transport_catalogue_serialize::Coordinates coordinates;
-        coordinates.set_lat(stop.coordinates.lat);
-        coordinates.set_lng(stop.coordinates.lng);
+namespace {
+const std::uint32_t SCHEMA_VERSION = 2;
+const char SECTIONED_BASE_SIGNATURE[8] = {'T', 'C', 'B', 'A', 'S', 'E', '\0', '\1'};
+// Размеры разделов выбраны так, чтобы каждый разбирался за доли миллисекунды и потоки делили работу ровно
+const size_t STOPS_PER_SECTION = 4096;
+const size_t BUSES_PER_SECTION = 512;
+const size_t ROAD_DISTANCES_PER_SECTION = 16384;
 
-        transport_catalogue_serialize::Stop stop_serialize;
-        stop_serialize.set_name(stop.name);
-        *stop_serialize.mutable_coordinates() = std::move(coordinates);
+#ifdef TRANSPORT_CATALOGUE_HAS_ZLIB
+// Сжатые данные читаются из потока кусками этого размера
+const size_t INFLATE_CHUNK_SIZE = 64 * 1024;
+
+// Возвращает nullopt, если zlib не смог сжать раздел
+std::optional<std::string> CompressSection(const std::string& data) {
+    std::string compressed(compressBound(data.size()), '\0');
+    uLongf compressed_size = compressed.size();
+    if (compress2(reinterpret_cast<Bytef*>(compressed.data()), &compressed_size,
+                  reinterpret_cast<const Bytef*>(data.data()), data.size(), Z_BEST_COMPRESSION) != Z_OK) {
+        return std::nullopt;
+    }
+    compressed.resize(compressed_size);
+    return compressed;
+}
 
-        *catalogue_serialize.add_stop() = std::move(stop_serialize);
+// Распаковывает раздел, читая из потока не больше compressed_size байт, и проверяет,
+// что он занял ровно size байт
+bool InflateSection(std::istream& in, size_t compressed_size, char* data, size_t size) {
+    z_stream stream{};
+    if (inflateInit(&stream) != Z_OK) {
+        return false;
     }
+    stream.next_out = reinterpret_cast<Bytef*>(data);
+    stream.avail_out = size;
+    
+    char chunk[INFLATE_CHUNK_SIZE];
+    int result = Z_OK;
+    while (result == Z_OK && compressed_size != 0) {
+        const size_t chunk_size = std::min(compressed_size, sizeof(chunk));
+        if (!in.read(chunk, chunk_size)) {
+            break;
+        }
+        compressed_size -= chunk_size;
+        stream.next_in = reinterpret_cast<Bytef*>(chunk);
+        stream.avail_in = chunk_size;
+        result = inflate(&stream, Z_NO_FLUSH);
+    }
+    const bool is_inflated = result == Z_STREAM_END && stream.avail_out == 0;
+    inflateEnd(&stream);
+    return is_inflated;
+}
+#endif
+
+bool DeserializeRoutesByName(const transport_catalogue_serialize::TransportCatalogue& catalogue_serialize,
+                             transport_catalogue::TransportCatalogue& transport_catalogue) {
+    for (const auto& bus_deserialized: catalogue_serialize.bus()) {
+        int stop_count = bus_deserialized.stop_name_size();
+        if (!bus_deserialized.is_roundtrip() && !bus_deserialized.route_stored_once()) {
+            stop_count = (stop_count + 1) / 2;
+        }
+        
+        // Остановки ищутся по имени прямо в сообщении, без промежуточных копий строк
+        std::vector<const domain::Stop*> route;
+        route.reserve(stop_count);
+        for (int j = 0; j != stop_count; ++j) {
+            const auto* stop = transport_catalogue.FindStop(bus_deserialized.stop_name(j));
+            if (!stop) {
+                return false;
+            }
+            route.push_back(stop);
+        }
 
-    auto buses = db.GetBuses();
-    for(const auto& bus: buses) {
-        transport_catalogue_serialize::Bus bus_serialize;
-        bus_serialize.set_name(bus.name);
-        bus_serialize.set_is_roundtrip(bus.is_roundtrip);
+        transport_catalogue.AddBus(bus_deserialized.name(), std::move(route), bus_deserialized.is_roundtrip());
+    }
 
-        for (auto stop: bus.route) {
-            *bus_serialize.add_stop_name() = stop->name;
+    for (const auto& road_distance_deserialized: catalogue_serialize.road_distance()) {
+        auto from = transport_catalogue.FindStop(road_distance_deserialized.from());
+        auto to = transport_catalogue.FindStop(road_distance_deserialized.to());
+        if (!from || !to) {
+            return false;
         }
 
-        *catalogue_serialize.add_bus() = std::move(bus_serialize);
+        transport_catalogue.SetDistanceBetweenStops(from, to, road_distance_deserialized.distance());
     }
+    return true;
+}
 
-    auto road_distances = db.GetRoadDistances();
-    for (const auto [stop_ptr_pair, distance]: road_distances ) {
-        transport_catalogue_serialize::RoadDistance road_distance_serialize;
-        road_distance_serialize.set_from(stop_ptr_pair.first->name);
-        road_distance_serialize.set_to(stop_ptr_pair.second->name);
-        road_distance_serialize.set_distance(distance);
+// Номера остановок проверяются, так как без поиска по имени ошибка в файле не проявилась бы иначе
+bool DeserializeRoutesById(const transport_catalogue_serialize::TransportCatalogue& catalogue_serialize,
+                           transport_catalogue::TransportCatalogue& transport_catalogue) {
+    const auto& stops = transport_catalogue.GetStops();
+    
+    for (const auto& bus_deserialized: catalogue_serialize.bus()) {
+        std::vector<const domain::Stop*> route;
+        route.reserve(bus_deserialized.stop_id_size());
+        for (auto stop_id: bus_deserialized.stop_id()) {
+            if (stop_id >= stops.size()) {
+                return false;
+            }
+            route.push_back(&stops[stop_id]);
+        }
+        transport_catalogue.AddBus(bus_deserialized.name(), std::move(route), bus_deserialized.is_roundtrip());
+    }
+    return true;
+}
 
-        *catalogue_serialize.add_road_distance() = std::move(road_distance_serialize);
+bool DeserializeRoadDistanceTable(const transport_catalogue_serialize::RoadDistanceTable& road_distance_table,
+                                  transport_catalogue::TransportCatalogue& transport_catalogue) {
+    const auto& stops = transport_catalogue.GetStops();
+    
+    if (road_distance_table.to_delta_size() != road_distance_table.from_delta_size()
+        || road_distance_table.distance_size() != road_distance_table.from_delta_size()) {
+        return false;
     }
+    std::uint64_t from = 0;
+    std::uint64_t to = 0;
+    for (int i = 0; i != road_distance_table.from_delta_size(); ++i) {
+        if (road_distance_table.from_delta(i) != 0) {
+            from += road_distance_table.from_delta(i);
+            to = 0;
+        }
+        to += road_distance_table.to_delta(i);
+        if (from >= stops.size() || to >= stops.size()) {
+            return false;
+        }
+        transport_catalogue.SetDistanceBetweenStops(&stops[from], &stops[to], road_distance_table.distance(i));
+    }
+    return true;
+}
+}
 
-    auto settings_serialize = SerializeRenderSettings(render_settings);
-    *catalogue_serialize.mutable_render_settings() = std::move(settings_serialize);
+bool SerializeTransportCatalogue(std::ostream& out, const transport_catalogue::CatalogueSnapshot& db,
+                                 const RenderSettings& render_settings, const RoutingSettings& routing_settings,
+                                 bool compress_sections, bool store_router_graph) {
+    using transport_catalogue_serialize::BaseSection;
+    
+    const auto& columns = db.GetColumns();
+    std::vector<std::pair<BaseSection::Type, std::string>> sections;
+    
+    transport_catalogue_serialize::TransportCatalogue catalogue_serialize;
+    catalogue_serialize.set_version(SCHEMA_VERSION);
+    *catalogue_serialize.mutable_stop_name_index() = SerializeNameIndex(db.GetStopNameIndex());
+    *catalogue_serialize.mutable_bus_name_index() = SerializeNameIndex(db.GetBusNameIndex());
+    *catalogue_serialize.mutable_stop_prefix_index() = SerializeNamePrefixIndex(db.GetStopPrefixIndex());
+    *catalogue_serialize.mutable_bus_prefix_index() = SerializeNamePrefixIndex(db.GetBusPrefixIndex());
+    *catalogue_serialize.mutable_stop_spatial_index() = SerializeStopSpatialIndex(db.GetStopSpatialIndex());
+    sections.emplace_back(BaseSection::CATALOGUE, catalogue_serialize.SerializeAsString());
+    
+    for (size_t first_stop_id = 0; first_stop_id < columns.GetStopCount(); first_stop_id += STOPS_PER_SECTION) {
+        transport_catalogue_serialize::TransportCatalogue stops_serialize;
+        const auto last_stop_id = std::min(first_stop_id + STOPS_PER_SECTION, columns.GetStopCount());
+        for (size_t stop_id = first_stop_id; stop_id != last_stop_id; ++stop_id) {
+            const auto stop_coordinates = columns.GetStopCoordinates(stop_id);
+            auto& stop_serialize = *stops_serialize.add_stop();
+            stop_serialize.set_name(std::string{columns.GetStopName(stop_id)});
+            stop_serialize.mutable_coordinates()->set_lat(stop_coordinates.lat);
+            stop_serialize.mutable_coordinates()->set_lng(stop_coordinates.lng);
+        }
+        sections.emplace_back(BaseSection::STOPS, stops_serialize.SerializeAsString());
+    }
+    
+    for (size_t first_bus_id = 0; first_bus_id < columns.GetBusCount(); first_bus_id += BUSES_PER_SECTION) {
+        transport_catalogue_serialize::TransportCatalogue buses_serialize;
+        const auto last_bus_id = std::min(first_bus_id + BUSES_PER_SECTION, columns.GetBusCount());
+        for (size_t bus_id = first_bus_id; bus_id != last_bus_id; ++bus_id) {
+            auto& bus_serialize = *buses_serialize.add_bus();
+            bus_serialize.set_name(std::string{columns.GetBusName(bus_id)});
+            bus_serialize.set_is_roundtrip(columns.IsRoundtrip(bus_id));
+            bus_serialize.set_route_stored_once(true);
+            
+            const auto route = columns.GetBusRoute(bus_id);
+            bus_serialize.mutable_stop_id()->Add(route.begin(), route.end());
+        }
+        sections.emplace_back(BaseSection::BUSES, buses_serialize.SerializeAsString());
+    }
+    
+    // Расстояния снимка уже упорядочены по (from, to), что и нужно для разностей
+    transport_catalogue_serialize::RoadDistanceTable road_distance_table;
+    size_t previous_from = 0;
+    std::uint32_t previous_to = 0;
+    for (size_t stop_id = 0; stop_id != columns.GetStopCount(); ++stop_id) {
+        if (stop_id != previous_from) {
+            previous_to = 0;
+        }
+        for (const auto& road_distance: db.GetRoadDistances(stop_id)) {
+            road_distance_table.add_from_delta(stop_id - previous_from);
+            road_distance_table.add_to_delta(road_distance.to - previous_to);
+            road_distance_table.add_distance(road_distance.distance);
+            previous_from = stop_id;
+            previous_to = road_distance.to;
+            
+            if (static_cast<size_t>(road_distance_table.distance_size()) == ROAD_DISTANCES_PER_SECTION) {
+                sections.emplace_back(BaseSection::ROAD_DISTANCES, road_distance_table.SerializeAsString());
+                road_distance_table.Clear();
+                previous_from = 0;
+                previous_to = 0;
+            }
+        }
+    }
+    if (road_distance_table.distance_size() != 0) {
+        sections.emplace_back(BaseSection::ROAD_DISTANCES, road_distance_table.SerializeAsString());
+    }
+    
+    sections.emplace_back(BaseSection::RENDER_SETTINGS, SerializeRenderSettings(render_settings).SerializeAsString());
+    sections.emplace_back(BaseSection::ROUTING_SETTINGS, SerializeRoutingSettings(routing_settings).SerializeAsString());
+    if (store_router_graph) {
+        sections.emplace_back(BaseSection::ROUTER_GRAPH,
+                              SerializeRouterGraph(TransportRouter::BuildGraph(db, routing_settings)).SerializeAsString());
+    }
     
-    auto routing_settings_serialize = SerializeRoutingSettings(routing_settings);
-    *catalogue_serialize.mutable_routing_settings() = std::move(routing_settings_serialize);
+    transport_catalogue_serialize::BaseContents contents;
+    std::uint64_t offset = 0;
+    for (auto& [type, data]: sections) {
+        auto& section = *contents.add_section();
+        section.set_type(type);
+        section.set_uncompressed_size(data.size());
+#ifdef TRANSPORT_CATALOGUE_HAS_ZLIB
+        if (compress_sections) {
+            contents.set_compression(transport_catalogue_serialize::BaseContents::ZLIB);
+            auto compressed = CompressSection(data);
+            if (!compressed) {
+                return false;
+            }
+            data = std::move(*compressed);
+        }
+#endif
+        section.set_offset(offset);
+        section.set_size(data.size());
+        offset += data.size();
+    }
     
-    catalogue_serialize.SerializeToOstream(&out);
+    // Подпись, длина оглавления (4 байта, младший байт первым), оглавление и разделы подряд
+    const auto contents_data = contents.SerializeAsString();
+    const std::uint32_t contents_size = contents_data.size();
+    const char contents_size_bytes[] = {static_cast<char>(contents_size), static_cast<char>(contents_size >> 8),
+                                        static_cast<char>(contents_size >> 16), static_cast<char>(contents_size >> 24)};
+    out.write(SECTIONED_BASE_SIGNATURE, sizeof(SECTIONED_BASE_SIGNATURE));
+    out.write(contents_size_bytes, sizeof(contents_size_bytes));
+    out << contents_data;
+    for (const auto& [type, data]: sections) {
+        out << data;
+    }
+    return static_cast<bool>(out);
 }
 
 svg::Color TransformToSvgColor(const svg_serialize::Color& color_serialize) {
@@ -170,40 +375,404 @@ void DeserializeRenderSettings(const render_settings_serialize::RenderSettings&
     }
 } 
 
-void DeserializeTransportCatalogue(std::istream& in, transport_catalogue::TransportCatalogue& transport_catalogue,
-                                   RenderSettings& render_settings, RoutingSettings& routing_settings) {
-    transport_catalogue_serialize::TransportCatalogue catalogue_serialize;
-    catalogue_serialize.ParseFromIstream(&in);
+namespace {
+// Индексы имён нужны справочнику до добавления остановок и автобусов, поэтому их число
+// передаётся сюда заранее, подсчитанное по уже разобранным сообщениям
+bool DeserializeNameIndexes(const transport_catalogue_serialize::TransportCatalogue& catalogue_serialize,
+                            size_t stop_count, size_t bus_count, transport_catalogue::TransportCatalogue& transport_catalogue) {
+    if (catalogue_serialize.has_stop_name_index() && catalogue_serialize.has_bus_name_index()) {
+        auto stop_name_index = DeserializeNameIndex(catalogue_serialize.stop_name_index(), stop_count);
+        auto bus_name_index = DeserializeNameIndex(catalogue_serialize.bus_name_index(), bus_count);
+        if (!stop_name_index || !bus_name_index) {
+            return false;
+        }
+        transport_catalogue.SetNameIndexes(std::move(*stop_name_index), std::move(*bus_name_index));
+    }
+    return true;
+}
+
+// Индексы поиска ссылаются на номера остановок и автобусов, поэтому читаются после них и проверяются по их числу
+bool DeserializeSearchIndexes(const transport_catalogue_serialize::TransportCatalogue& catalogue_serialize,
+                              transport_catalogue::TransportCatalogue& transport_catalogue) {
+    if (catalogue_serialize.has_stop_prefix_index() && catalogue_serialize.has_bus_prefix_index()) {
+        auto stop_prefix_index = DeserializeNamePrefixIndex(catalogue_serialize.stop_prefix_index(), transport_catalogue.GetStops().size());
+        auto bus_prefix_index = DeserializeNamePrefixIndex(catalogue_serialize.bus_prefix_index(), transport_catalogue.GetBuses().size());
+        if (!stop_prefix_index || !bus_prefix_index) {
+            return false;
+        }
+        transport_catalogue.SetPrefixIndexes(std::move(*stop_prefix_index), std::move(*bus_prefix_index));
+    }
+    if (catalogue_serialize.has_stop_spatial_index()) {
+        auto stop_spatial_index = DeserializeStopSpatialIndex(catalogue_serialize.stop_spatial_index(), transport_catalogue.GetStops().size());
+        if (!stop_spatial_index) {
+            return false;
+        }
+        transport_catalogue.SetStopSpatialIndex(std::move(*stop_spatial_index));
+    }
+    return true;
+}
 
-    for (int i = 0; i != catalogue_serialize.stop_size(); ++i) {
-        auto stop_deserialized = catalogue_serialize.stop(i);
+void DeserializeStops(const transport_catalogue_serialize::TransportCatalogue& catalogue_serialize,
+                      transport_catalogue::TransportCatalogue& transport_catalogue) {
+    for (const auto& stop_deserialized: catalogue_serialize.stop()) {
         transport_catalogue.AddStop(stop_deserialized.name(), 
                                     stop_deserialized.coordinates().lat(), 
                                     stop_deserialized.coordinates().lng());
     }
+}
+
+// База, записанная одним сообщением TransportCatalogue, до появления разделов
+bool DeserializeSingleMessage(std::istream& in, transport_catalogue::TransportCatalogue& transport_catalogue,
+                              RenderSettings& render_settings, RoutingSettings& routing_settings) {
+    google::protobuf::Arena arena;
+    auto& catalogue_serialize = *google::protobuf::Arena::CreateMessage<transport_catalogue_serialize::TransportCatalogue>(&arena);
+    if (!catalogue_serialize.ParseFromIstream(&in)) {
+        return false;
+    }
+    
+    if (!DeserializeNameIndexes(catalogue_serialize, catalogue_serialize.stop_size(), catalogue_serialize.bus_size(), transport_catalogue)) {
+        return false;
+    }
+    DeserializeStops(catalogue_serialize, transport_catalogue);
 
-    for (int i = 0; i != catalogue_serialize.bus_size(); ++i) {
-        auto bus_deserialized = catalogue_serialize.bus(i);
+    const bool is_loaded = catalogue_serialize.version() >= 2
+        ? DeserializeRoutesById(catalogue_serialize, transport_catalogue)
+            && DeserializeRoadDistanceTable(catalogue_serialize.road_distance_table(), transport_catalogue)
+        : DeserializeRoutesByName(catalogue_serialize, transport_catalogue);
+    if (!is_loaded || !DeserializeSearchIndexes(catalogue_serialize, transport_catalogue)) {
+        return false;
+    }
+
+    DeserializeRenderSettings(catalogue_serialize.render_settings(), render_settings);
+    DeserializeRoutingSettings(catalogue_serialize.routing_settings(), routing_settings);
+    return true;
+}
 
-        std::vector<std::string> stop_names;
-        for (int j = 0; j != bus_deserialized.stop_name_size(); ++j) {
-            stop_names.push_back(bus_deserialized.stop_name(j));
+// Читает оглавление и по нему только нужные разделы
+class SectionedBaseReader {
+public:
+    explicit SectionedBaseReader(std::istream& in)
+        : in_(in) {
+    }
+    
+    bool ReadContents() {
+        char contents_size_bytes[4];
+        if (!in_.read(contents_size_bytes, sizeof(contents_size_bytes))) {
+            return false;
+        }
+        std::uint32_t contents_size = 0;
+        for (int i = 3; i >= 0; --i) {
+            contents_size = contents_size << 8 | static_cast<unsigned char>(contents_size_bytes[i]);
+        }
+        
+        std::string contents_data(contents_size, '\0');
+        if (!in_.read(contents_data.data(), contents_size) || !contents_.ParseFromString(contents_data)) {
+            return false;
+        }
+        data_begin_ = in_.tellg();
+        return true;
+    }
+    
+    bool IsCompressed() const {
+        return contents_.compression() != transport_catalogue_serialize::BaseContents::NONE;
+    }
+    
+    size_t CountSections(transport_catalogue_serialize::BaseSection::Type type) const {
+        return std::count_if(contents_.section().begin(), contents_.section().end(),
+                             [type](const auto& section) { return section.type() == type; });
+    }
+    
+    // Дописывает байты всех разделов данного типа по порядку в общий буфер
+    bool ReadSections(transport_catalogue_serialize::BaseSection::Type type, std::string& buffer,
+                      std::vector<std::pair<size_t, size_t>>& sections) {
+        for (const auto& section: contents_.section()) {
+            if (section.type() != type) {
+                continue;
+            }
+            const size_t offset = buffer.size();
+            const size_t size = GetDataSize(section);
+            buffer.resize(offset + size);
+            in_.seekg(data_begin_ + static_cast<std::streamoff>(section.offset()));
+            if (!ReadSectionData(section, buffer.data() + offset)) {
+                return false;
+            }
+            sections.emplace_back(offset, size);
+        }
+        return true;
+    }
+    
+    // Суммарный размер разделов данного типа, чтобы заранее выделить буфер
+    size_t GetSectionsSize(transport_catalogue_serialize::BaseSection::Type type) const {
+        size_t size = 0;
+        for (const auto& section: contents_.section()) {
+            if (section.type() == type) {
+                size += GetDataSize(section);
+            }
+        }
+        return size;
+    }
+    
+private:
+    std::istream& in_;
+    transport_catalogue_serialize::BaseContents contents_;
+    std::streampos data_begin_;
+    
+    size_t GetDataSize(const transport_catalogue_serialize::BaseSection& section) const {
+        return IsCompressed() ? section.uncompressed_size() : section.size();
+    }
+    
+    bool ReadSectionData(const transport_catalogue_serialize::BaseSection& section, char* data) {
+        if (!IsCompressed()) {
+            return static_cast<bool>(in_.read(data, section.size()));
         }
+#ifdef TRANSPORT_CATALOGUE_HAS_ZLIB
+        return contents_.compression() == transport_catalogue_serialize::BaseContents::ZLIB
+            && InflateSection(in_, section.size(), data, section.uncompressed_size());
+#else
+        return false;
+#endif
+    }
+};
 
-        transport_catalogue.AddBus(bus_deserialized.name(), stop_names, bus_deserialized.is_roundtrip());
+// Разбирает каждый раздел в своё сообщение. Разделы раздаются потокам по одному, пока не кончатся
+bool ParseSections(const std::string& buffer, const std::vector<std::pair<size_t, size_t>>& sections,
+                   const std::vector<google::protobuf::Message*>& messages) {
+    std::atomic<size_t> next_section = 0;
+    std::atomic<bool> is_parsed = true;
+    auto parse = [&] {
+        for (size_t i = next_section++; i < sections.size(); i = next_section++) {
+            const auto [offset, size] = sections[i];
+            if (!messages[i]->ParseFromArray(buffer.data() + offset, static_cast<int>(size))) {
+                is_parsed = false;
+            }
+        }
+    };
+    
+    const size_t thread_count = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), sections.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < thread_count; ++i) {
+        workers.emplace_back(parse);
+    }
+    parse();
+    for (auto& worker: workers) {
+        worker.join();
     }
+    return is_parsed;
+}
 
-    for (int i = 0; i != catalogue_serialize.road_distance_size(); ++i) {
-        auto road_distance_deserialized = catalogue_serialize.road_distance(i);
-        
-        auto from = transport_catalogue.FindStop(road_distance_deserialized.from());
-        auto to = transport_catalogue.FindStop(road_distance_deserialized.to());
+template <typename Message>
+std::vector<Message*> CreateMessages(google::protobuf::Arena& arena, size_t count) {
+    std::vector<Message*> messages(count);
+    for (auto& message: messages) {
+        message = google::protobuf::Arena::CreateMessage<Message>(&arena);
+    }
+    return messages;
+}
+}
 
-        transport_catalogue.SetDistanceBetweenStops(from, to, road_distance_deserialized.distance());
+// Сначала все нужные разделы читаются из потока в один буфер, затем параллельно разбираются
+// в сообщения на общей арене, и только после этого один поток связывает их в справочник в порядке номеров.
+// Арена освобождает все сообщения разом, а строки и массивы справочника копируются из них по ссылке
+bool DeserializeTransportCatalogue(std::istream& in, transport_catalogue::TransportCatalogue& transport_catalogue,
+                                   RenderSettings& render_settings, RoutingSettings& routing_settings, BaseParts parts,
+                                   std::optional<TransportRouter::GraphData>* router_graph) {
+    using transport_catalogue_serialize::BaseSection;
+    
+    char signature[sizeof(SECTIONED_BASE_SIGNATURE)] = {};
+    if (!in.read(signature, sizeof(signature)) || std::memcmp(signature, SECTIONED_BASE_SIGNATURE, sizeof(signature)) != 0) {
+        in.clear();
+        in.seekg(0);
+        return DeserializeSingleMessage(in, transport_catalogue, render_settings, routing_settings);
+    }
+    
+    SectionedBaseReader reader(in);
+    if (!reader.ReadContents() || reader.CountSections(BaseSection::CATALOGUE) != 1
+        || (parts.render_settings && reader.CountSections(BaseSection::RENDER_SETTINGS) != 1)
+        || (parts.routing_settings && reader.CountSections(BaseSection::ROUTING_SETTINGS) != 1)
+        || reader.CountSections(BaseSection::ROUTER_GRAPH) > 1) {
+        return false;
+    }
+    const bool has_router_graph = router_graph && reader.CountSections(BaseSection::ROUTER_GRAPH) == 1;
+    
+    std::vector<BaseSection::Type> types = {BaseSection::CATALOGUE, BaseSection::STOPS, BaseSection::BUSES, BaseSection::ROAD_DISTANCES};
+    if (parts.render_settings) {
+        types.push_back(BaseSection::RENDER_SETTINGS);
+    }
+    if (parts.routing_settings) {
+        types.push_back(BaseSection::ROUTING_SETTINGS);
+    }
+    if (has_router_graph) {
+        types.push_back(BaseSection::ROUTER_GRAPH);
+    }
+    size_t buffer_size = 0;
+    for (auto type: types) {
+        buffer_size += reader.GetSectionsSize(type);
+    }
+    
+    // Разобранные сообщения по объёму сравнимы с исходными байтами, поэтому арене
+    // сразу отдаётся блок такого размера и обычно хватает нескольких блоков
+    google::protobuf::ArenaOptions arena_options;
+    arena_options.start_block_size = std::max(arena_options.start_block_size, buffer_size);
+    arena_options.max_block_size = std::max(arena_options.max_block_size, buffer_size);
+    google::protobuf::Arena arena(arena_options);
+    
+    const auto catalogue_serialize = CreateMessages<transport_catalogue_serialize::TransportCatalogue>(arena, 1);
+    const auto stops_serialize = CreateMessages<transport_catalogue_serialize::TransportCatalogue>(
+        arena, reader.CountSections(BaseSection::STOPS));
+    const auto buses_serialize = CreateMessages<transport_catalogue_serialize::TransportCatalogue>(
+        arena, reader.CountSections(BaseSection::BUSES));
+    const auto road_distance_tables = CreateMessages<transport_catalogue_serialize::RoadDistanceTable>(
+        arena, reader.CountSections(BaseSection::ROAD_DISTANCES));
+    const auto render_settings_serialize = CreateMessages<render_settings_serialize::RenderSettings>(arena, parts.render_settings);
+    const auto routing_settings_serialize = CreateMessages<transport_router_serialize::RoutingSettings>(arena, parts.routing_settings);
+    const auto router_graph_serialize = CreateMessages<transport_router_serialize::RouterGraph>(arena, has_router_graph);
+    
+    std::string buffer;
+    buffer.reserve(buffer_size);
+    std::vector<std::pair<size_t, size_t>> sections;
+    std::vector<google::protobuf::Message*> messages;
+    auto add_sections = [&](BaseSection::Type type, const auto& section_messages) {
+        messages.insert(messages.end(), section_messages.begin(), section_messages.end());
+        return reader.ReadSections(type, buffer, sections);
+    };
+    if (!add_sections(BaseSection::CATALOGUE, catalogue_serialize)
+        || !add_sections(BaseSection::STOPS, stops_serialize)
+        || !add_sections(BaseSection::BUSES, buses_serialize)
+        || !add_sections(BaseSection::ROAD_DISTANCES, road_distance_tables)
+        || (parts.render_settings && !add_sections(BaseSection::RENDER_SETTINGS, render_settings_serialize))
+        || (parts.routing_settings && !add_sections(BaseSection::ROUTING_SETTINGS, routing_settings_serialize))
+        || (has_router_graph && !add_sections(BaseSection::ROUTER_GRAPH, router_graph_serialize))
+        || !ParseSections(buffer, sections, messages)) {
+        return false;
+    }
+    
+    // Остановки и автобусы могут лежать и в самом разделе справочника
+    size_t stop_count = catalogue_serialize.front()->stop_size();
+    for (const auto* stops_section: stops_serialize) {
+        stop_count += stops_section->stop_size();
+    }
+    size_t bus_count = catalogue_serialize.front()->bus_size();
+    for (const auto* buses_section: buses_serialize) {
+        bus_count += buses_section->bus_size();
+    }
+    if (!DeserializeNameIndexes(*catalogue_serialize.front(), stop_count, bus_count, transport_catalogue)) {
+        return false;
+    }
+    DeserializeStops(*catalogue_serialize.front(), transport_catalogue);
+    for (const auto* stops_section: stops_serialize) {
+        DeserializeStops(*stops_section, transport_catalogue);
+    }
+    if (!DeserializeRoutesById(*catalogue_serialize.front(), transport_catalogue)) {
+        return false;
+    }
+    for (const auto* buses_section: buses_serialize) {
+        if (!DeserializeRoutesById(*buses_section, transport_catalogue)) {
+            return false;
+        }
+    }
+    for (const auto* road_distance_table: road_distance_tables) {
+        if (!DeserializeRoadDistanceTable(*road_distance_table, transport_catalogue)) {
+            return false;
+        }
+    }
+    if (!DeserializeSearchIndexes(*catalogue_serialize.front(), transport_catalogue)) {
+        return false;
+    }
+    
+    if (parts.render_settings) {
+        DeserializeRenderSettings(*render_settings_serialize.front(), render_settings);
     }
+    if (parts.routing_settings) {
+        DeserializeRoutingSettings(*routing_settings_serialize.front(), routing_settings);
+    }
+    if (has_router_graph) {
+        *router_graph = DeserializeRouterGraph(*router_graph_serialize.front(), transport_catalogue.GetStops().size(),
+                                               transport_catalogue.GetBuses().size());
+        if (!*router_graph) {
+            return false;
+        }
+    }
+    return true;
+}
 
-    DeserializeRenderSettings(catalogue_serialize.render_settings(), render_settings);
-    DeserializeRoutingSettings(catalogue_serialize.routing_settings(), routing_settings);
+transport_catalogue_serialize::NameIndex SerializeNameIndex(const perfect_hash::NameIndex& index) {
+    transport_catalogue_serialize::NameIndex index_serialize;
+    
+    index_serialize.set_seed(index.GetSeed());
+    for (auto displacement: index.GetDisplacements()) {
+        index_serialize.add_displacement(displacement);
+    }
+    for (auto slot: index.GetSlots()) {
+        index_serialize.add_slot(slot);
+    }
+    
+    return index_serialize;
+}
+
+std::optional<perfect_hash::NameIndex> DeserializeNameIndex(const transport_catalogue_serialize::NameIndex& index_serialize, size_t count) {
+    perfect_hash::NameIndex index(index_serialize.seed(),
+                                  std::vector<std::uint32_t>(index_serialize.displacement().begin(), index_serialize.displacement().end()),
+                                  std::vector<std::uint32_t>(index_serialize.slot().begin(), index_serialize.slot().end()));
+    if (!index.IsValid(count)) {
+        return std::nullopt;
+    }
+    return index;
+}
+
+transport_catalogue_serialize::NamePrefixIndex SerializeNamePrefixIndex(const transport_catalogue::NamePrefixIndex& index) {
+    transport_catalogue_serialize::NamePrefixIndex index_serialize;
+    for (auto id: index.GetOrder()) {
+        index_serialize.add_id(id);
+    }
+    return index_serialize;
+}
+
+std::optional<transport_catalogue::NamePrefixIndex> DeserializeNamePrefixIndex(const transport_catalogue_serialize::NamePrefixIndex& index_serialize,
+                                                                               size_t count) {
+    transport_catalogue::NamePrefixIndex index(std::vector<std::uint32_t>(index_serialize.id().begin(), index_serialize.id().end()));
+    if (!index.IsValid(count)) {
+        return std::nullopt;
+    }
+    return index;
+}
+
+transport_catalogue_serialize::StopSpatialIndex SerializeStopSpatialIndex(const transport_catalogue::StopSpatialIndex& index) {
+    transport_catalogue_serialize::StopSpatialIndex index_serialize;
+    const auto& grid = index.GetGrid();
+    
+    index_serialize.set_min_lat(grid.min_lat);
+    index_serialize.set_min_lng(grid.min_lng);
+    index_serialize.set_cell_lat(grid.cell_lat);
+    index_serialize.set_cell_lng(grid.cell_lng);
+    index_serialize.set_rows(grid.rows);
+    index_serialize.set_cols(grid.cols);
+    for (auto offset: index.GetCellOffsets()) {
+        index_serialize.add_cell_offset(offset);
+    }
+    for (auto stop_id: index.GetStops()) {
+        index_serialize.add_stop(stop_id);
+    }
+    
+    return index_serialize;
+}
+
+std::optional<transport_catalogue::StopSpatialIndex> DeserializeStopSpatialIndex(const transport_catalogue_serialize::StopSpatialIndex& index_serialize,
+                                                                                 size_t stop_count) {
+    transport_catalogue::StopSpatialIndex::Grid grid;
+    grid.min_lat = index_serialize.min_lat();
+    grid.min_lng = index_serialize.min_lng();
+    grid.cell_lat = index_serialize.cell_lat();
+    grid.cell_lng = index_serialize.cell_lng();
+    grid.rows = index_serialize.rows();
+    grid.cols = index_serialize.cols();
+    
+    transport_catalogue::StopSpatialIndex index(grid,
+                                                std::vector<std::uint32_t>(index_serialize.cell_offset().begin(), index_serialize.cell_offset().end()),
+                                                std::vector<std::uint32_t>(index_serialize.stop().begin(), index_serialize.stop().end()));
+    if (!index.IsValid(stop_count)) {
+        return std::nullopt;
+    }
+    return index;
 }
 
 transport_router_serialize::RoutingSettings SerializeRoutingSettings(const RoutingSettings& settings) {
@@ -220,3 +789,134 @@ void DeserializeRoutingSettings(const transport_router_serialize::RoutingSetting
     settings.bus_velocity = settings_serialize.bus_velocity();
 }
 
+transport_router_serialize::RouterGraph SerializeRouterGraph(const TransportRouter::GraphData& graph_data) {
+    transport_router_serialize::RouterGraph graph_serialize;
+    const auto& graph = graph_data.graph;
+    
+    graph_serialize.set_vertex_count(graph.GetVertexCount());
+    for (graph::EdgeId edge_id = 0; edge_id != graph.GetEdgeCount(); ++edge_id) {
+        const auto& edge = graph.GetEdge(edge_id);
+        graph_serialize.add_edge_from(edge.from);
+        graph_serialize.add_edge_to(edge.to);
+        graph_serialize.add_edge_weight(edge.weight);
+        graph_serialize.add_edge_bus(graph_data.edges[edge_id].bus);
+        graph_serialize.add_edge_span_count(graph_data.edges[edge_id].span_count);
+    }
+    
+    graph_serialize.add_incidence_offset(0);
+    for (graph::VertexId vertex = 0; vertex != graph.GetVertexCount(); ++vertex) {
+        for (auto edge_id: graph.GetIncidentEdges(vertex)) {
+            graph_serialize.add_incidence_edge(edge_id);
+        }
+        graph_serialize.add_incidence_offset(graph_serialize.incidence_edge_size());
+    }
+    
+    return graph_serialize;
+}
+
+std::optional<TransportRouter::GraphData> DeserializeRouterGraph(const transport_router_serialize::RouterGraph& graph_serialize,
+                                                                 size_t stop_count, size_t bus_count) {
+    const size_t vertex_count = graph_serialize.vertex_count();
+    const size_t edge_count = graph_serialize.edge_from_size();
+    if (vertex_count != stop_count * 2
+        || static_cast<size_t>(graph_serialize.edge_to_size()) != edge_count
+        || static_cast<size_t>(graph_serialize.edge_weight_size()) != edge_count
+        || static_cast<size_t>(graph_serialize.edge_bus_size()) != edge_count
+        || static_cast<size_t>(graph_serialize.edge_span_count_size()) != edge_count
+        || static_cast<size_t>(graph_serialize.incidence_offset_size()) != vertex_count + 1
+        || graph_serialize.incidence_offset(0) != 0
+        || graph_serialize.incidence_offset(vertex_count) != static_cast<std::uint32_t>(graph_serialize.incidence_edge_size())) {
+        return std::nullopt;
+    }
+    
+    std::vector<graph::Edge<double>> edges;
+    std::vector<TransportRouter::EdgeInfo> edge_infos;
+    edges.reserve(edge_count);
+    edge_infos.reserve(edge_count);
+    for (size_t edge_id = 0; edge_id != edge_count; ++edge_id) {
+        const auto from = graph_serialize.edge_from(edge_id);
+        const auto to = graph_serialize.edge_to(edge_id);
+        const auto bus = graph_serialize.edge_bus(edge_id);
+        if (from >= vertex_count || to >= vertex_count || bus >= bus_count) {
+            return std::nullopt;
+        }
+        edges.push_back({from, to, graph_serialize.edge_weight(edge_id)});
+        edge_infos.push_back({bus, graph_serialize.edge_span_count(edge_id)});
+    }
+    
+    std::vector<std::vector<graph::EdgeId>> incidence_lists(vertex_count);
+    for (size_t vertex = 0; vertex != vertex_count; ++vertex) {
+        const auto begin = graph_serialize.incidence_offset(vertex);
+        const auto end = graph_serialize.incidence_offset(vertex + 1);
+        if (begin > end) {
+            return std::nullopt;
+        }
+        incidence_lists[vertex].reserve(end - begin);
+        for (auto i = begin; i != end; ++i) {
+            const auto edge_id = graph_serialize.incidence_edge(i);
+            if (edge_id >= edge_count || edges[edge_id].from != vertex) {
+                return std::nullopt;
+            }
+            incidence_lists[vertex].push_back(edge_id);
+        }
+    }
+    
+    return TransportRouter::GraphData{TransportRouter::Graph(std::move(edges), std::move(incidence_lists)), std::move(edge_infos)};
+}
+
+
+std::shared_ptr<const transport_catalogue::CatalogueSnapshot> LoadSnapshot(const std::string& file_name,
+                                                                           RenderSettings& render_settings, RoutingSettings& routing_settings,
+                                                                           BaseParts parts,
+                                                                           std::optional<TransportRouter::GraphData>* router_graph) {
+    if (transport_catalogue::BaseImage::IsImage(file_name)) {
+        return transport_catalogue::BaseImage::Map(file_name, render_settings, routing_settings);
+    }
+    
+    transport_catalogue::TransportCatalogue transport_catalogue;
+    std::ifstream in(file_name, std::ios::binary);
+    if (!in || !DeserializeTransportCatalogue(in, transport_catalogue, render_settings, routing_settings, parts, router_graph)) {
+        return nullptr;
+    }
+    return transport_catalogue.Freeze();
+}
+
+bool LoadTransportCatalogue(const std::string& file_name, transport_catalogue::TransportCatalogue& transport_catalogue,
+                            RenderSettings& render_settings, RoutingSettings& routing_settings) {
+    if (transport_catalogue::BaseImage::IsImage(file_name)) {
+        auto snapshot = transport_catalogue::BaseImage::Map(file_name, render_settings, routing_settings);
+        if (!snapshot) {
+            return false;
+        }
+        transport_catalogue.Restore(*snapshot);
+        return true;
+    }
+    
+    std::ifstream in(file_name, std::ios::binary);
+    return in && DeserializeTransportCatalogue(in, transport_catalogue, render_settings, routing_settings);
+}
+
+transport_catalogue::BaseFormat DetectBaseFormat(const std::string& file_name) {
+    if (transport_catalogue::BaseImage::IsImage(file_name)) {
+        return transport_catalogue::BaseFormat::IMAGE;
+    }
+    
+    std::ifstream in(file_name, std::ios::binary);
+    char signature[sizeof(SECTIONED_BASE_SIGNATURE)] = {};
+    if (!in.read(signature, sizeof(signature)) || std::memcmp(signature, SECTIONED_BASE_SIGNATURE, sizeof(signature)) != 0) {
+        return transport_catalogue::BaseFormat::PROTOBUF;
+    }
+    SectionedBaseReader reader(in);
+    return reader.ReadContents() && reader.IsCompressed() ? transport_catalogue::BaseFormat::COMPRESSED_PROTOBUF
+                                                          : transport_catalogue::BaseFormat::PROTOBUF;
+}
+
+bool SaveTransportCatalogue(std::ostream& out, const transport_catalogue::CatalogueSnapshot& db, transport_catalogue::BaseFormat format,
+                            const RenderSettings& render_settings, const RoutingSettings& routing_settings, bool store_router_graph) {
+    if (format == transport_catalogue::BaseFormat::IMAGE) {
+        transport_catalogue::BaseImage::Write(out, db, render_settings, routing_settings);
+        return static_cast<bool>(out);
+    }
+    return SerializeTransportCatalogue(out, db, render_settings, routing_settings,
+                                       format == transport_catalogue::BaseFormat::COMPRESSED_PROTOBUF, store_router_graph);
+}
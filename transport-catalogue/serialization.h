@@ -1,6 +1,8 @@
 #pragma once 
 
 #include "transport_catalogue.h"
+#include "catalogue_snapshot.h"
+#include "base_image.h"
 #include "map_renderer.h"
 #include "serialization.h"
 #include "transport_router.h"
@@ -13,17 +15,63 @@
 #include <transport_router.pb.h>
 
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
 
-void SerializeTransportCatalogue(std::ostream& out, const transport_catalogue::TransportCatalogue& db,
-                                  const RenderSettings& render_settings, const RoutingSettings& routing_settings);
-void DeserializeTransportCatalogue(std::istream& in, transport_catalogue::TransportCatalogue& transport_catalogue,
-                                   RenderSettings& render_settings, RoutingSettings& routing_settings);
+// Части базы, которые можно не читать. Справочник с расстояниями читается всегда
+struct BaseParts {
+    bool render_settings = true;
+    bool routing_settings = true;
+};
+
+// База пишется разделами с оглавлением, и каждый раздел читается отдельно от остальных.
+// Сжатые разделы распаковываются при чтении потоково, прямо из файла.
+// Граф маршрутизации пишется, только если задан store_router_graph: он растёт как сумма квадратов длин маршрутов.
+// Возвращает false, если раздел не удалось сжать или записать: тогда записанное в поток нельзя считать базой
+bool SerializeTransportCatalogue(std::ostream& out, const transport_catalogue::CatalogueSnapshot& db,
+                                 const RenderSettings& render_settings, const RoutingSettings& routing_settings,
+                                 bool compress_sections = false, bool store_router_graph = false);
+// Возвращает false, если поток не содержит корректной базы. Базы, записанные одним сообщением, читаются целиком.
+// Граф маршрутизации читается, только если передан router_graph и он есть в базе, иначе router_graph остаётся пустым
+bool DeserializeTransportCatalogue(std::istream& in, transport_catalogue::TransportCatalogue& transport_catalogue,
+                                   RenderSettings& render_settings, RoutingSettings& routing_settings, BaseParts parts = {},
+                                   std::optional<TransportRouter::GraphData>* router_graph = nullptr);
+// Читает базу любого формата и возвращает готовый к запросам снимок или nullptr, если файл не удалось прочитать
+std::shared_ptr<const transport_catalogue::CatalogueSnapshot> LoadSnapshot(const std::string& file_name,
+                                                                           RenderSettings& render_settings, RoutingSettings& routing_settings,
+                                                                           BaseParts parts = {},
+                                                                           std::optional<TransportRouter::GraphData>* router_graph = nullptr);
+// Наполняет справочник из базы любого формата. Возвращает false, если файл не удалось прочитать
+bool LoadTransportCatalogue(const std::string& file_name, transport_catalogue::TransportCatalogue& transport_catalogue,
+                            RenderSettings& render_settings, RoutingSettings& routing_settings);
+// Формат, в котором записан файл базы, чтобы обновлённая база сохранялась в нём же
+transport_catalogue::BaseFormat DetectBaseFormat(const std::string& file_name);
+// Возвращает false, если базу не удалось записать. Образ графа маршрутизации не хранит
+bool SaveTransportCatalogue(std::ostream& out, const transport_catalogue::CatalogueSnapshot& db, transport_catalogue::BaseFormat format,
+                            const RenderSettings& render_settings, const RoutingSettings& routing_settings,
+                            bool store_router_graph = false);
 
 svg_serialize::Color TransformToSerializeColor(const svg::Color& color);
 render_settings_serialize::RenderSettings SerializeRenderSettings(const RenderSettings& settings);
 svg::Color TransformToSvgColor(const svg_serialize::Color& color_serialize);
 void DeserializeRenderSettings(const render_settings_serialize::RenderSettings& settings_serialize,
                                             RenderSettings& settings);
+transport_catalogue_serialize::NameIndex SerializeNameIndex(const perfect_hash::NameIndex& index);
+// Возвращает nullopt, если индекс не соответствует набору из count имён
+std::optional<perfect_hash::NameIndex> DeserializeNameIndex(const transport_catalogue_serialize::NameIndex& index_serialize, size_t count);
+transport_catalogue_serialize::NamePrefixIndex SerializeNamePrefixIndex(const transport_catalogue::NamePrefixIndex& index);
+// Возвращает nullopt, если индекс не является перестановкой номеров от 0 до count - 1
+std::optional<transport_catalogue::NamePrefixIndex> DeserializeNamePrefixIndex(const transport_catalogue_serialize::NamePrefixIndex& index_serialize,
+                                                                               size_t count);
+transport_catalogue_serialize::StopSpatialIndex SerializeStopSpatialIndex(const transport_catalogue::StopSpatialIndex& index);
+// Возвращает nullopt, если индекс не соответствует справочнику с данным числом остановок
+std::optional<transport_catalogue::StopSpatialIndex> DeserializeStopSpatialIndex(const transport_catalogue_serialize::StopSpatialIndex& index_serialize,
+                                                                                 size_t stop_count);
 transport_router_serialize::RoutingSettings SerializeRoutingSettings(const RoutingSettings& settings);
 void DeserializeRoutingSettings(const transport_router_serialize::RoutingSettings& settings_serialize, RoutingSettings& settings);
+transport_router_serialize::RouterGraph SerializeRouterGraph(const TransportRouter::GraphData& graph_data);
+// Возвращает nullopt, если граф не соответствует справочнику с данным числом остановок и автобусов
+std::optional<TransportRouter::GraphData> DeserializeRouterGraph(const transport_router_serialize::RouterGraph& graph_serialize,
+                                                                 size_t stop_count, size_t bus_count);
 
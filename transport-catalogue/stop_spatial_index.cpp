@@ -0,0 +1,208 @@
+#define _USE_MATH_DEFINES
+#include "stop_spatial_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+namespace transport_catalogue {
+    
+namespace {
+const size_t STOPS_PER_CELL = 2;
+const double EARTH_RADIUS = 6371000;
+const double MIN_CELL_SIZE = 1e-9;
+
+double ToMeters(double degrees) {
+    return degrees * M_PI / 180. * EARTH_RADIUS;
+}
+}
+    
+StopSpatialIndex::StopSpatialIndex(const CatalogueColumns& columns) {
+    const size_t stop_count = columns.GetStopCount();
+    const auto& lats = columns.GetLatitudes();
+    const auto& lngs = columns.GetLongitudes();
+    
+    if (stop_count == 0) {
+        cell_offsets_ = std::vector<std::uint32_t>(1, 0);
+        return;
+    }
+    
+    const auto [min_lat, max_lat] = std::minmax_element(lats.begin(), lats.end());
+    const auto [min_lng, max_lng] = std::minmax_element(lngs.begin(), lngs.end());
+    const auto side = static_cast<std::uint32_t>(std::ceil(std::sqrt(static_cast<double>(stop_count) / STOPS_PER_CELL)));
+    
+    grid_.min_lat = *min_lat;
+    grid_.min_lng = *min_lng;
+    grid_.rows = std::max<std::uint32_t>(side, 1);
+    grid_.cols = grid_.rows;
+    grid_.cell_lat = std::max<double>((*max_lat - *min_lat) / grid_.rows, MIN_CELL_SIZE);
+    grid_.cell_lng = std::max<double>((*max_lng - *min_lng) / grid_.cols, MIN_CELL_SIZE);
+    
+    std::vector<std::uint32_t> cells(stop_count);
+    std::vector<std::uint32_t> cell_offsets(static_cast<size_t>(grid_.rows) * grid_.cols + 1, 0);
+    for (size_t stop_id = 0; stop_id != stop_count; ++stop_id) {
+        cells[stop_id] = GetRow(lats[stop_id]) * grid_.cols + GetCol(lngs[stop_id]);
+        ++cell_offsets[cells[stop_id] + 1];
+    }
+    std::partial_sum(cell_offsets.begin(), cell_offsets.end(), cell_offsets.begin());
+    
+    std::vector<std::uint32_t> stops(stop_count);
+    std::vector<std::uint32_t> positions(cell_offsets.begin(), cell_offsets.end() - 1);
+    for (size_t stop_id = 0; stop_id != stop_count; ++stop_id) {
+        stops[positions[cells[stop_id]]++] = stop_id;
+    }
+    
+    cell_offsets_ = std::move(cell_offsets);
+    stops_ = std::move(stops);
+}
+    
+StopSpatialIndex::StopSpatialIndex(Grid grid, storage::Column<std::uint32_t> cell_offsets, storage::Column<std::uint32_t> stops)
+    : grid_(grid)
+    , cell_offsets_(std::move(cell_offsets))
+    , stops_(std::move(stops)) {
+}
+    
+bool StopSpatialIndex::IsBuilt() const {
+    return !cell_offsets_.empty();
+}
+    
+size_t StopSpatialIndex::GetSize() const {
+    return stops_.size();
+}
+    
+bool StopSpatialIndex::IsValid(size_t stop_count) const {
+    // У пустого индекса сетки нет, а у непустого по ней считаются номера ячеек
+    const bool is_grid_valid = stops_.empty()
+        || (std::isfinite(grid_.min_lat) && std::isfinite(grid_.min_lng) && grid_.cell_lat > 0 && grid_.cell_lng > 0);
+    return is_grid_valid && stops_.size() == stop_count
+        && storage::IsValidOffsets(cell_offsets_, std::uint64_t{grid_.rows} * grid_.cols, 0, stops_.size())
+        && storage::AreIdsBelow(stops_, stop_count);
+}
+    
+std::vector<std::pair<double, std::uint32_t>> StopSpatialIndex::FindNearest(const CatalogueColumns& columns, geo::Coordinates point,
+                                                                            size_t count, double max_distance) const {
+    std::vector<std::pair<double, std::uint32_t>> result;
+    if (stops_.empty() || count == 0) {
+        return result;
+    }
+    
+    // Ячейки просматриваются кольцами вокруг ячейки точки, пока нижняя оценка расстояния
+    // до непросмотренных ячеек не превысит расстояние до count-й найденной остановки
+    const auto row = GetRow(point.lat);
+    const auto col = GetCol(point.lng);
+    const auto max_radius = std::max({row, grid_.rows - 1 - row, col, grid_.cols - 1 - col});
+    
+    for (std::uint32_t radius = 0; radius <= max_radius; ++radius) {
+        for (std::int64_t r = std::int64_t{row} - radius; r <= std::int64_t{row} + radius; ++r) {
+            if (r < 0 || r >= grid_.rows) {
+                continue;
+            }
+            const bool is_edge_row = r == std::int64_t{row} - radius || r == std::int64_t{row} + radius;
+            const std::int64_t step = is_edge_row ? 1 : std::max<std::int64_t>(2 * radius, 1);
+            for (std::int64_t c = std::int64_t{col} - radius; c <= std::int64_t{col} + radius; c += step) {
+                if (c < 0 || c >= grid_.cols) {
+                    continue;
+                }
+                const auto cell = r * grid_.cols + c;
+                for (auto i = cell_offsets_[cell]; i != cell_offsets_[cell + 1]; ++i) {
+                    const double distance = geo::ComputeDistance(point, columns.GetStopCoordinates(stops_[i]));
+                    if (distance <= max_distance) {
+                        result.emplace_back(distance, stops_[i]);
+                    }
+                }
+            }
+        }
+        
+        const double bound = GetLowerBound(point, row, col, radius);
+        if (bound > max_distance) {
+            break;
+        }
+        if (result.size() >= count) {
+            std::nth_element(result.begin(), result.begin() + count - 1, result.end());
+            if (result[count - 1].first <= bound) {
+                break;
+            }
+        }
+    }
+    
+    std::sort(result.begin(), result.end());
+    if (result.size() > count) {
+        result.resize(count);
+    }
+    return result;
+}
+    
+std::vector<std::uint32_t> StopSpatialIndex::FindInBox(const CatalogueColumns& columns, geo::Coordinates min, geo::Coordinates max) const {
+    std::vector<std::uint32_t> result;
+    if (stops_.empty() || min.lat > max.lat || min.lng > max.lng) {
+        return result;
+    }
+    
+    for (auto row = GetRow(min.lat); row <= GetRow(max.lat); ++row) {
+        for (auto col = GetCol(min.lng); col <= GetCol(max.lng); ++col) {
+            const auto cell = row * grid_.cols + col;
+            for (auto i = cell_offsets_[cell]; i != cell_offsets_[cell + 1]; ++i) {
+                const auto coordinates = columns.GetStopCoordinates(stops_[i]);
+                if (coordinates.lat >= min.lat && coordinates.lat <= max.lat
+                    && coordinates.lng >= min.lng && coordinates.lng <= max.lng) {
+                    result.push_back(stops_[i]);
+                }
+            }
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+    
+const StopSpatialIndex::Grid& StopSpatialIndex::GetGrid() const {
+    return grid_;
+}
+    
+const storage::Column<std::uint32_t>& StopSpatialIndex::GetCellOffsets() const {
+    return cell_offsets_;
+}
+    
+const storage::Column<std::uint32_t>& StopSpatialIndex::GetStops() const {
+    return stops_;
+}
+    
+std::uint32_t StopSpatialIndex::GetRow(double lat) const {
+    const double row = std::floor((lat - grid_.min_lat) / grid_.cell_lat);
+    return static_cast<std::uint32_t>(std::clamp(row, 0., grid_.rows - 1.));
+}
+    
+std::uint32_t StopSpatialIndex::GetCol(double lng) const {
+    const double col = std::floor((lng - grid_.min_lng) / grid_.cell_lng);
+    return static_cast<std::uint32_t>(std::clamp(col, 0., grid_.cols - 1.));
+}
+    
+// Нижняя оценка расстояния от точки до остановок вне квадрата ячеек радиуса radius.
+// Стороны квадрата, за которыми сетка кончается, не учитываются: там остановок нет.
+// Расстояние по долготе оценивается по наибольшей широте сетки, что верно для масштабов города
+double StopSpatialIndex::GetLowerBound(geo::Coordinates point, std::uint32_t row, std::uint32_t col, std::uint32_t radius) const {
+    double bound = std::numeric_limits<double>::infinity();
+    
+    if (row >= radius) {
+        const double edge = grid_.min_lat + (row - radius) * grid_.cell_lat;
+        bound = std::min(bound, ToMeters(std::max(point.lat - edge, 0.)));
+    }
+    if (row + radius + 1 < grid_.rows) {
+        const double edge = grid_.min_lat + (row + radius + 1) * grid_.cell_lat;
+        bound = std::min(bound, ToMeters(std::max(edge - point.lat, 0.)));
+    }
+    
+    const double max_lat = std::max({std::abs(grid_.min_lat), std::abs(grid_.min_lat + grid_.rows * grid_.cell_lat), std::abs(point.lat)});
+    const double lng_scale = std::cos(max_lat * M_PI / 180.);
+    if (col >= radius) {
+        const double edge = grid_.min_lng + (col - radius) * grid_.cell_lng;
+        bound = std::min(bound, ToMeters(std::max(point.lng - edge, 0.)) * lng_scale);
+    }
+    if (col + radius + 1 < grid_.cols) {
+        const double edge = grid_.min_lng + (col + radius + 1) * grid_.cell_lng;
+        bound = std::min(bound, ToMeters(std::max(edge - point.lng, 0.)) * lng_scale);
+    }
+    return bound;
+}
+}
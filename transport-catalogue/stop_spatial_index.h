@@ -0,0 +1,58 @@
+#pragma once
+
+#include "geo.h"
+#include "catalogue_columns.h"
+#include "column.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace transport_catalogue {
+    
+// Равномерная сетка над координатами остановок. Остановки разложены по ячейкам в CSR-виде:
+// остановки ячейки cell лежат в stops_[cell_offsets_[cell], cell_offsets_[cell + 1]).
+// Индекс хранит только id остановок, координаты берутся из колонок справочника
+class StopSpatialIndex {
+public:
+    struct Grid {
+        double min_lat = 0;
+        double min_lng = 0;
+        double cell_lat = 0;
+        double cell_lng = 0;
+        std::uint32_t rows = 0;
+        std::uint32_t cols = 0;
+    };
+    
+    StopSpatialIndex() = default;
+    explicit StopSpatialIndex(const CatalogueColumns& columns);
+    StopSpatialIndex(Grid grid, storage::Column<std::uint32_t> cell_offsets, storage::Column<std::uint32_t> stops);
+    
+    bool IsBuilt() const;
+    // Число остановок, по которым построен индекс
+    size_t GetSize() const;
+    // Подходит ли индекс к справочнику из stop_count остановок. Нужна для индекса, прочитанного из файла:
+    // поиск не проверяет ни смещения ячеек, ни номера остановок
+    bool IsValid(size_t stop_count) const;
+    
+    // Не более count ближайших к point остановок на расстоянии не дальше max_distance метров,
+    // упорядоченные по возрастанию расстояния. Элемент - пара {расстояние, id остановки}
+    std::vector<std::pair<double, std::uint32_t>> FindNearest(const CatalogueColumns& columns, geo::Coordinates point,
+                                                               size_t count, double max_distance) const;
+    // Остановки внутри прямоугольника, в порядке id
+    std::vector<std::uint32_t> FindInBox(const CatalogueColumns& columns, geo::Coordinates min, geo::Coordinates max) const;
+    
+    const Grid& GetGrid() const;
+    const storage::Column<std::uint32_t>& GetCellOffsets() const;
+    const storage::Column<std::uint32_t>& GetStops() const;
+    
+private:
+    Grid grid_;
+    storage::Column<std::uint32_t> cell_offsets_;
+    storage::Column<std::uint32_t> stops_;
+    
+    std::uint32_t GetRow(double lat) const;
+    std::uint32_t GetCol(double lng) const;
+    double GetLowerBound(geo::Coordinates point, std::uint32_t row, std::uint32_t col, std::uint32_t radius) const;
+};
+}
@@ -1,168 +1,177 @@
 #include "transport_catalogue.h"
-#include "geo.h"
+#include "catalogue_snapshot.h"
 #include "domain.h"
 
 #include <string>
 #include <vector>
-#include <map>
 #include <utility>
-#include <iostream>
-#include <numeric>
-#include <functional>
-#include <optional>
-#include <unordered_set>
-#include <set>
+#include <memory>
 #include <string_view>
-#include <algorithm>
-#include <iterator>
 #include <deque>
+#include <algorithm>
 
 using namespace std::literals;
 
 namespace transport_catalogue {
     
-void TransportCatalogue::AddStop(const std::string& name, double lat, double lng) {
-    stops_.emplace_back(name, lat, lng);
-    stops_lookup_[stops_.back().name] = &stops_.back();
-    stop_to_buses_.emplace(&stops_.back(), std::set<std::string_view>{});
-} 
-
-const domain::Stop* TransportCatalogue::FindStop(std::string_view name) const{
-    if (stops_lookup_.count(name)) {
-        return stops_lookup_.at(name);
+void TransportCatalogue::Restore(const CatalogueSnapshot& snapshot) {
+    const auto& columns = snapshot.GetColumns();
+    
+    for (size_t stop_id = 0; stop_id != columns.GetStopCount(); ++stop_id) {
+        const auto coordinates = columns.GetStopCoordinates(stop_id);
+        AddStop(columns.GetStopName(stop_id), coordinates.lat, coordinates.lng);
     }
-    return nullptr;
-}
-
-const std::optional<domain::StopStat> TransportCatalogue::GetStopStat(std::string_view name) const {
-    auto stop = FindStop(name);
     
-    if (!stop) {
-        return std::nullopt;
+    for (size_t stop_id = 0; stop_id != columns.GetStopCount(); ++stop_id) {
+        for (const auto& road_distance: snapshot.GetRoadDistances(stop_id)) {
+            SetDistanceBetweenStops(&stops_[stop_id], &stops_[road_distance.to], road_distance.distance);
+        }
     }
     
-    return domain::StopStat{stop->name, stop_to_buses_.at(stop)};
+    for (size_t bus_id = 0; bus_id != columns.GetBusCount(); ++bus_id) {
+        std::vector<std::string_view> stop_names;
+        for (auto stop_id: columns.GetBusRoute(bus_id)) {
+            stop_names.push_back(columns.GetStopName(stop_id));
+        }
+        AddBus(columns.GetBusName(bus_id), stop_names, columns.IsRoundtrip(bus_id));
+    }
 }
+    
+void TransportCatalogue::AddStop(std::string_view name, double lat, double lng) {
+    stops_.emplace_back(std::string{name}, lat, lng, stops_.size());
+    if (stops_.back().id >= stop_name_index_.GetSize()) {
+        stops_lookup_[stops_.back().name] = &stops_.back();
+    }
+} 
 
-double TransportCatalogue::GetDistanceBetweenStops(const domain::Stop* stop1, const domain::Stop* stop2) const {
-    if (road_distances_.count(std::make_pair(stop1, stop2))) {
-        return road_distances_.at(std::make_pair(stop1, stop2));
-    } else if (road_distances_.count(std::make_pair(stop2, stop1))) {
-        return road_distances_.at(std::make_pair(stop2, stop1));
-    } else {
-        return geo::ComputeDistance(stop2->coordinates, stop1->coordinates);
+const domain::Stop* TransportCatalogue::FindStop(std::string_view name) const{
+    if (auto id = stop_name_index_.Find(name); id && *id < stops_.size() && stops_[*id].name == name) {
+        return &stops_[*id];
     }
+    
+    auto it = stops_lookup_.find(name);
+    return it != stops_lookup_.end() ? it->second : nullptr;
 }
 
 void TransportCatalogue::SetDistanceBetweenStops(const domain::Stop* stop1, const domain::Stop* stop2, int distance) {
-    road_distances_.emplace(std::make_pair(std::make_pair(stop1, stop2), distance));
-}
-
-std::vector<geo::Coordinates> TransportCatalogue::GetStopsCoordinates() const {
-    std::vector<geo::Coordinates> result;
-    for (const auto& [stop, buses]: stop_to_buses_) {
-        if (!buses.empty()) {
-            result.push_back(stop->coordinates);
-        }
-    }
-    return result;
-}
-    
-size_t TransportCatalogue::GetStopCount() const {
-    return stops_.size();
+    road_distances_.insert_or_assign(std::make_pair(stop1, stop2), distance);
 }
     
 const std::deque<domain::Stop>& TransportCatalogue::GetStops() const {
     return stops_;
 }
     
-void TransportCatalogue::AddBus(const std::string& name, const std::vector<std::string>& stop_names, bool is_roundtrip) {
+bool TransportCatalogue::AddBus(std::string_view name, const std::vector<std::string_view>& stop_names, bool is_roundtrip) {
+    auto route = ResolveRoute(stop_names);
+    if (!route) {
+        return false;
+    }
+    AddBus(name, std::move(*route), is_roundtrip);
+    return true;
+}
+    
+void TransportCatalogue::AddBus(std::string_view name, std::vector<const domain::Stop*> route, bool is_roundtrip) {
     domain::Bus bus;
     
     bus.name = name;
     bus.is_roundtrip = is_roundtrip;
-    
-    for (const std::string& name: stop_names) {
-        auto stop = FindStop(name);
-        bus.route.push_back(stop);
-    }
+    bus.route = std::move(route);
     
     buses_.push_back(std::move(bus));
-    buses_lookup_[buses_.back().name] = &buses_.back();
-    
-    for (const auto& stop: buses_.back().route) {
-        stop_to_buses_[stop].insert(buses_.back().name);
-    } 
-}
-
-const domain::Bus* TransportCatalogue::FindBus(std::string_view name) const {
-    if (buses_lookup_.count(name)) {
-        return buses_lookup_.at(name);
+    if (buses_.size() > bus_name_index_.GetSize()) {
+        buses_lookup_[buses_.back().name] = &buses_.back();
     }
-    return nullptr;
 }
-
-const std::optional<domain::BusStat> TransportCatalogue::GetBusStat(std::string_view name) const {
-    auto bus = FindBus(name);
-    if (!bus) {
-        return std::nullopt;
+    
+bool TransportCatalogue::ModifyBus(const domain::Bus* bus, const std::vector<std::string_view>& stop_names, bool is_roundtrip) {
+    auto route = ResolveRoute(stop_names);
+    if (!route) {
+        return false;
     }
+    auto& modified_bus = const_cast<domain::Bus&>(*bus);
+    modified_bus.route = std::move(*route);
+    modified_bus.is_roundtrip = is_roundtrip;
+    return true;
+}
     
-    int stop_count = bus->route.size();
-    std::unordered_set unique_stops(bus->route.begin(), bus->route.end());
-    int unique_stop_count = unique_stops.size();
-    
-    auto geo_distance = std::transform_reduce(
-        bus->route.begin() + 1,
-        bus->route.end(),
-        bus->route.begin(),
-        0.,
-        std::plus<>(),
-        [](auto next, auto prev) {
-            return geo::ComputeDistance(prev->coordinates, next->coordinates);
-        });
-    
-    auto real_distance = std::transform_reduce(
-        bus->route.begin() + 1,
-        bus->route.end(),
-        bus->route.begin(),
-        0.,
-        std::plus<>(),
-        [this](auto next, auto prev) {
-            return GetDistanceBetweenStops(prev, next);
-        });
-    
-    auto curvature = real_distance / geo_distance;
-    return domain::BusStat{bus->name, stop_count, unique_stop_count, real_distance, curvature};
-}
-    
-domain::MapStat TransportCatalogue::GetRoutesMapStat() const {
-    std::set<const domain::Bus*, domain::detail::BusPtrCompare> buses;
+void TransportCatalogue::RemoveBus(const domain::Bus* bus) {
+    auto it = std::find_if(buses_.begin(), buses_.end(), [bus](const auto& item) { return &item == bus; });
+    buses_.erase(it);
+    
+    // Удаление сдвигает номера и адреса автобусов, поэтому индексы имён строятся заново
+    bus_name_index_ = {};
+    bus_prefix_index_ = {};
+    buses_lookup_.clear();
     for (const auto& bus: buses_) {
-        if (!bus.route.empty()) {
-            buses.insert(&bus);
-        }
+        buses_lookup_[bus.name] = &bus;
     }
-    
-    std::set<const domain::Stop*, domain::detail::StopPtrCompare> stops;
-    for (const auto& [stop, buses]: stop_to_buses_) {
-        if (!buses.empty()) {
-            stops.insert(stop);
-        }
+}
+
+const domain::Bus* TransportCatalogue::FindBus(std::string_view name) const {
+    if (auto id = bus_name_index_.Find(name); id && *id < buses_.size() && buses_[*id].name == name) {
+        return &buses_[*id];
     }
-    return {buses, stops};
+    
+    auto it = buses_lookup_.find(name);
+    return it != buses_lookup_.end() ? it->second : nullptr;
 }
     
 const std::deque<domain::Bus>& TransportCatalogue::GetBuses() const {
     return buses_;
 }
     
-size_t TransportCatalogue::GetStopIdByName(const std::string& name) const {
-    auto it = std::find_if(stops_.begin(), stops_.end(), [name](const auto& item) { return item.name == name;});
-    return std::distance(stops_.begin(), it);
-}
-    
 const TransportCatalogue::RoadDistances& TransportCatalogue::GetRoadDistances() const {
     return road_distances_;
 }
-}
\ No newline at end of file
+    
+const perfect_hash::NameIndex& TransportCatalogue::GetStopNameIndex() const {
+    return stop_name_index_;
+}
+    
+const perfect_hash::NameIndex& TransportCatalogue::GetBusNameIndex() const {
+    return bus_name_index_;
+}
+    
+void TransportCatalogue::SetNameIndexes(perfect_hash::NameIndex stop_name_index, perfect_hash::NameIndex bus_name_index) {
+    stop_name_index_ = std::move(stop_name_index);
+    bus_name_index_ = std::move(bus_name_index);
+}
+    
+void TransportCatalogue::SetPrefixIndexes(NamePrefixIndex stop_prefix_index, NamePrefixIndex bus_prefix_index) {
+    stop_prefix_index_ = std::move(stop_prefix_index);
+    bus_prefix_index_ = std::move(bus_prefix_index);
+}
+    
+const NamePrefixIndex& TransportCatalogue::GetStopPrefixIndex() const {
+    return stop_prefix_index_;
+}
+    
+const NamePrefixIndex& TransportCatalogue::GetBusPrefixIndex() const {
+    return bus_prefix_index_;
+}
+    
+void TransportCatalogue::SetStopSpatialIndex(StopSpatialIndex stop_spatial_index) {
+    stop_spatial_index_ = std::move(stop_spatial_index);
+}
+    
+const StopSpatialIndex& TransportCatalogue::GetStopSpatialIndex() const {
+    return stop_spatial_index_;
+}
+    
+std::shared_ptr<const CatalogueSnapshot> TransportCatalogue::Freeze() const {
+    return std::make_shared<const CatalogueSnapshot>(*this);
+}
+    
+std::optional<std::vector<const domain::Stop*>> TransportCatalogue::ResolveRoute(const std::vector<std::string_view>& stop_names) const {
+    std::vector<const domain::Stop*> route;
+    route.reserve(stop_names.size());
+    for (std::string_view name: stop_names) {
+        const auto* stop = FindStop(name);
+        if (!stop) {
+            return std::nullopt;
+        }
+        route.push_back(stop);
+    }
+    return route;
+}
+}
@@ -2,48 +2,81 @@
 
 #include "geo.h"
 #include "domain.h"
+#include "catalogue_snapshot.h"
+#include "name_prefix_index.h"
+#include "perfect_hash.h"
+#include "stop_spatial_index.h"
 
 #include <unordered_map>
 #include <string>
 #include <deque>
+#include <memory>
+#include <optional>
 #include <string_view>
 #include <vector>
-#include <optional>
-#include <set>
 #include <utility>
 
 namespace transport_catalogue {
     
+// Изменяемая часть справочника: наполняется базовыми запросами или из файла базы.
+// Запросы к готовому справочнику обслуживает неизменяемый снимок, который возвращает Freeze()
 class TransportCatalogue {
 public:
     using RoadDistances = std::unordered_map<const std::pair<const domain::Stop*, const domain::Stop*>, int, domain::detail::StopPairHasher>;
     
     TransportCatalogue() = default;
     
-    void AddStop(const std::string& name, double lat, double lng);
+    // Наполняет пустой справочник остановками, расстояниями и маршрутами снимка
+    void Restore(const CatalogueSnapshot& snapshot);
+    
+    void AddStop(std::string_view name, double lat, double lng);
     const domain::Stop* FindStop(std::string_view name) const;
-    const std::optional<domain::StopStat> GetStopStat(std::string_view name) const;
     void SetDistanceBetweenStops(const domain::Stop* stop1, const domain::Stop* stop2, int distance);
-    double GetDistanceBetweenStops(const domain::Stop* stop1, const domain::Stop* stop2) const;
-    std::vector<geo::Coordinates> GetStopsCoordinates() const;
-    size_t GetStopIdByName(const std::string& name) const;
-    size_t GetStopCount() const;
     const std::deque<domain::Stop>& GetStops() const;
     
-    void AddBus(const std::string& name, const std::vector<std::string>& stop_names, bool is_roundtrip);
+    // Возвращает false и не меняет справочник, если в маршруте есть неизвестная остановка
+    bool AddBus(std::string_view name, const std::vector<std::string_view>& stop_names, bool is_roundtrip);
+    // Маршрут из уже найденных остановок, без поиска по именам
+    void AddBus(std::string_view name, std::vector<const domain::Stop*> route, bool is_roundtrip);
+    // Изменение и удаление маршрутов нужны для точечного обновления готовой базы
+    // Как и AddBus, возвращает false и оставляет маршрут прежним, если в нём есть неизвестная остановка
+    bool ModifyBus(const domain::Bus* bus, const std::vector<std::string_view>& stop_names, bool is_roundtrip);
+    void RemoveBus(const domain::Bus* bus);
     const domain::Bus* FindBus(std::string_view name) const;
-    const std::optional<domain::BusStat> GetBusStat(std::string_view name) const;
-    domain::MapStat GetRoutesMapStat() const;
     const std::deque<domain::Bus>& GetBuses() const;
     
     const RoadDistances& GetRoadDistances() const;
+    const perfect_hash::NameIndex& GetStopNameIndex() const;
+    const perfect_hash::NameIndex& GetBusNameIndex() const;
+    
+    // Устанавливает готовые индексы имён, например прочитанные из файла базы.
+    // Вызывается до добавления остановок и маршрутов. Покрытые индексом имена не попадают
+    // в хеш-таблицы, а добавленные сверх индекса ищутся в хеш-таблицах как обычно
+    void SetNameIndexes(perfect_hash::NameIndex stop_name_index, perfect_hash::NameIndex bus_name_index);
+    // Готовые упорядочения имён из файла базы, основа поиска по префиксу
+    void SetPrefixIndexes(NamePrefixIndex stop_prefix_index, NamePrefixIndex bus_prefix_index);
+    const NamePrefixIndex& GetStopPrefixIndex() const;
+    const NamePrefixIndex& GetBusPrefixIndex() const;
+    // Готовый пространственный индекс из файла базы. Используется снимком, если покрывает все остановки
+    void SetStopSpatialIndex(StopSpatialIndex stop_spatial_index);
+    const StopSpatialIndex& GetStopSpatialIndex() const;
+    
+    std::shared_ptr<const CatalogueSnapshot> Freeze() const;
    
 private:
     std::deque<domain::Stop> stops_;
     std::deque<domain::Bus> buses_;
+    // Хеш-таблицы хранят имена, не покрытые индексами имён из файла базы
     std::unordered_map<std::string_view, const domain::Stop*> stops_lookup_;
     std::unordered_map<std::string_view, const domain::Bus*> buses_lookup_;
-    std::unordered_map<const domain::Stop*, std::set<std::string_view>> stop_to_buses_; 
+    perfect_hash::NameIndex stop_name_index_;
+    perfect_hash::NameIndex bus_name_index_;
+    NamePrefixIndex stop_prefix_index_;
+    NamePrefixIndex bus_prefix_index_;
+    StopSpatialIndex stop_spatial_index_;
     RoadDistances road_distances_;
+    
+    // nullopt, если хотя бы одной остановки нет в справочнике
+    std::optional<std::vector<const domain::Stop*>> ResolveRoute(const std::vector<std::string_view>& stop_names) const;
 };
-}
\ No newline at end of file
+}
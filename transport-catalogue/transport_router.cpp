@@ -1,5 +1,5 @@
 #include "transport_router.h"
-#include "transport_catalogue.h"
+#include "catalogue_snapshot.h"
 #include "router.h"
 
 #include <vector>
@@ -7,84 +7,92 @@
 #include <optional>
 #include <iostream>
 
-TransportRouter::TransportRouter(const transport_catalogue::TransportCatalogue& db,
+TransportRouter::TransportRouter(const transport_catalogue::CatalogueSnapshot& db,
                                  const RoutingSettings& settings) 
+    : TransportRouter(db, BuildGraph(db, settings)) {
+}
+
+TransportRouter::TransportRouter(const transport_catalogue::CatalogueSnapshot& db, GraphData graph_data)
     : db_(db)
-    , transport_router_(InitializeInternalData(settings)) {
+    , graph_data_(std::move(graph_data))
+    , transport_router_(graph_data_.graph) {
 }
 
 std::optional<TransportRouter::RouteInfo> TransportRouter::BuildRoute(std::string from, std::string to) const {
-    auto from_id = db_.GetStopIdByName(from);
-    auto to_id = db_.GetStopIdByName(to);
-    auto route = transport_router_.BuildRoute(from_id, to_id);
+    auto from_id = db_.FindStop(from);
+    auto to_id = db_.FindStop(to);
+    if (!from_id || !to_id) {
+        return std::nullopt;
+    }
+    auto route = transport_router_.BuildRoute(*from_id, *to_id);
     
     if (!route) {
         return std::nullopt;
     }
     
+    // Имена остановок восстанавливаются по вершинам ребра, а время - это его вес
+    const auto& columns = db_.GetColumns();
+    const size_t stop_count = columns.GetStopCount();
     RouteInfo route_info;
     route_info.total_time = route->weight;
     for (auto edge_id: route->edges) {
-        route_info.items.push_back(edge_descriptions_.at(edge_id));
+        const auto& edge = graph_data_.graph.GetEdge(edge_id);
+        const auto& edge_info = graph_data_.edges.at(edge_id);
+        route_info.items.push_back({
+            columns.GetStopName(edge.from % stop_count),
+            columns.GetStopName(edge.to % stop_count),
+            columns.GetBusName(edge_info.bus),
+            static_cast<int>(edge_info.span_count),
+            edge.weight
+        });
     }
     return route_info;
 }
 
-TransportRouter::Graph& TransportRouter::InitializeInternalData(const RoutingSettings& settings) {
-    Graph graph(db_.GetStopCount() * 2);
-    auto buses = db_.GetBuses();
+const TransportRouter::GraphData& TransportRouter::GetGraphData() const {
+    return graph_data_;
+}
+
+TransportRouter::GraphData TransportRouter::BuildGraph(const transport_catalogue::CatalogueSnapshot& db, const RoutingSettings& settings) {
+    const auto& columns = db.GetColumns();
+    const size_t stop_count = columns.GetStopCount();
+    GraphData graph_data{Graph(stop_count * 2), {}};
+    auto& graph = graph_data.graph;
     
-    for (const auto& bus: buses) {
-        for (size_t i = 0; i != bus.route.size(); ++i) {
-            int span_count = 0;
-            
-            RouteItem edge_description{
-                bus.route.at(i)->name,
-                bus.route.at(i)->name,
-                bus.name,
-                span_count,
-                static_cast<double>(settings.bus_wait_time)
-            };
-            
-            edge_descriptions_.push_back(edge_description);
-            
-            size_t stop1_id = db_.GetStopIdByName(edge_description.from);
-            size_t stop1_dup_id = stop1_id + db_.GetStopCount();
+    for (size_t bus_id = 0; bus_id != columns.GetBusCount(); ++bus_id) {
+        const auto route = columns.GetBusFullRoute(bus_id);
+        const size_t route_size = route.size();
+        
+        for (size_t i = 0; i != route_size; ++i) {
+            std::uint32_t span_count = 0;
+            size_t stop1_id = route[i];
+            size_t stop1_dup_id = stop1_id + stop_count;
             
             graph::Edge<double> edge{
                 stop1_id,
                 stop1_dup_id,
-                edge_description.time
+                static_cast<double>(settings.bus_wait_time)
             };
             
             graph.AddEdge(edge);
+            graph_data.edges.push_back({static_cast<std::uint32_t>(bus_id), span_count});
             
             double time = 0;
-            for (size_t j = i + 1; j != bus.route.size(); ++j) {
+            for (size_t j = i + 1; j != route_size; ++j) {
                 ++span_count;
-                auto distance = db_.GetDistanceBetweenStops(bus.route.at(j -1), bus.route.at(j));
+                auto distance = db.GetDistanceBetweenStops(route[j - 1], route[j]);
                 time += distance / (settings.bus_velocity * 1000. / 60);
                 
-                RouteItem edge_description{
-                    bus.route.at(i)->name,
-                    bus.route.at(j)->name,
-                    bus.name,
-                    span_count,
-                    time
-                };
-                
-                edge_descriptions_.push_back(edge_description);
-                
                 graph::Edge<double> edge{
                     stop1_dup_id,
-                    db_.GetStopIdByName(edge_description.to),
-                    edge_description.time
+                    route[j],
+                    time
                 };
                 
                 graph.AddEdge(edge);
+                graph_data.edges.push_back({static_cast<std::uint32_t>(bus_id), span_count});
             }
         }
     }
-    graph_ = std::move(graph);
-    return graph_;
+    return graph_data;
 }
@@ -1,18 +1,21 @@
 #pragma once
 
-#include "transport_catalogue.h"
+#include "catalogue_snapshot.h"
 #include "graph.h"
 #include "router.h"
 #include "domain.h"
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <optional>
 
+// Имена ссылаются на колонки снимка справочника и действительны, пока жив снимок
 struct RouteItem {
-    std::string from;
-    std::string to;
-    std::string bus;
+    std::string_view from;
+    std::string_view to;
+    std::string_view bus;
     int span_count;
     double time;
 };
@@ -26,8 +29,28 @@ class TransportRouter {
 public:
     using Graph = graph::DirectedWeightedGraph<double>;
     
-    TransportRouter(const transport_catalogue::TransportCatalogue& db,
+    // Вершина остановки s - s, вершина посадки на ней - s + число остановок.
+    // Ребро ожидания идёт из первой во вторую и имеет span_count == 0
+    struct EdgeInfo {
+        std::uint32_t bus;
+        std::uint32_t span_count;
+    };
+    
+    // Граф с описаниями рёбер не зависит от запросов, поэтому может храниться в базе
+    struct GraphData {
+        Graph graph;
+        std::vector<EdgeInfo> edges;
+    };
+    
+    static GraphData BuildGraph(const transport_catalogue::CatalogueSnapshot& db, const RoutingSettings& settings);
+    
+    TransportRouter(const transport_catalogue::CatalogueSnapshot& db,
                     const RoutingSettings& settings);
+    TransportRouter(const transport_catalogue::CatalogueSnapshot& db, GraphData graph_data);
+    
+    // Внутренний маршрутизатор ссылается на граф, поэтому роутер нельзя копировать и перемещать
+    TransportRouter(const TransportRouter&) = delete;
+    TransportRouter& operator=(const TransportRouter&) = delete;
     
     struct RouteInfo {
         std::vector<RouteItem> items;
@@ -35,13 +58,10 @@ public:
     };
     
     std::optional<RouteInfo> BuildRoute(std::string from, std::string to) const;
+    const GraphData& GetGraphData() const;
     
 private:
-    const transport_catalogue::TransportCatalogue& db_;
-    Graph graph_;
-    std::vector<RouteItem> edge_descriptions_;
+    const transport_catalogue::CatalogueSnapshot& db_;
+    GraphData graph_data_;
     graph::Router<double> transport_router_;
-    
-    Graph& InitializeInternalData(const RoutingSettings& settings);
-    
 };
\ No newline at end of file